@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "cmdline.h"
+#include "Game.hpp"
+#include "Trainer.hpp"
+#include "Trainer.cpp"
+
+// @brief Settings shared by every convergence run.
+struct ConvergenceConfig
+{
+    std::vector<double> targets; // Exploitability targets, sorted in decreasing order.
+    double maxSeconds;           // Wall-time budget of a single run, excluding evaluations.
+    uint64_t maxIterations;      // Iteration budget of a single run.
+    double evalGrowth;           // Factor by which the iteration interval between evaluations grows.
+    uint32_t seed;               // Seed of the trainer's random generator.
+    bool incremental;            // Flag indicating if exploitability is evaluated incrementally.
+    double tolerance;            // Strategy change triggering a recomputation in incremental evaluations.
+};
+
+// @brief State of the training run at the moment exploitability was evaluated.
+struct ConvergencePoint
+{
+    uint64_t iteration;    // Number of iterations completed.
+    double wallSeconds;    // Training wall time, excluding evaluations.
+    uint64_t nodesTouched; // Cumulative number of nodes touched.
+    double exploitability; // Exploitability of the average strategy.
+};
+
+// @brief Parses a comma-separated list of exploitability targets.
+// @param str The comma-separated list.
+// @return The targets, sorted in decreasing order.
+static std::vector<double> parseTargets(const std::string &str)
+{
+    std::vector<double> targets;
+    std::stringstream ss(str);
+    std::string item;
+    while (std::getline(ss, item, ','))
+    {
+        if (!item.empty())
+        {
+            targets.push_back(std::stod(item));
+        }
+    }
+    std::sort(targets.begin(), targets.end(), std::greater<double>());
+    return targets;
+}
+
+// @brief Trains one algorithm on one game until every target is reached or the budget is exhausted.
+// @tparam Type The game type.
+// @param mode The CFR variant.
+// @param config The run settings.
+// @param summary The stream receiving one row per target.
+// @param curve The stream receiving one row per evaluation, or nullptr.
+template <typename Type>
+void runConvergence(const std::string &mode, const ConvergenceConfig &config, std::ostream &summary, std::ostream *curve)
+{
+    Trainer::Trainer<Type> trainer(mode, config.seed);
+    if (config.incremental)
+    {
+        trainer.enableIncrementalExploitability(config.tolerance);
+    }
+    double utils[Type::playerNum()];
+
+    std::vector<ConvergencePoint> reached(config.targets.size());
+    std::vector<bool> isReached(config.targets.size(), false);
+    size_t nextTarget = 0;
+
+    ConvergencePoint point{0, 0.0, 0, 0.0};
+    uint64_t nextEval = 1;
+    while (nextTarget < config.targets.size() && point.iteration < config.maxIterations && point.wallSeconds < config.maxSeconds)
+    {
+        // train up to the next evaluation point; evaluation time is not charged to the algorithm
+        const auto start = std::chrono::steady_clock::now();
+        for (; point.iteration < nextEval; ++point.iteration)
+        {
+            trainer.iterate(point.iteration, utils);
+        }
+        point.wallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        point.nodesTouched = trainer.nodeTouchedCount();
+        point.exploitability = trainer.exploitability();
+        nextEval = std::max(nextEval + 1, uint64_t(double(nextEval) * config.evalGrowth));
+
+        if (curve != nullptr)
+        {
+            *curve << Type::name() << "," << mode << "," << point.iteration << "," << point.wallSeconds << ","
+                   << point.nodesTouched << "," << point.exploitability << "\n";
+        }
+        while (nextTarget < config.targets.size() && point.exploitability <= config.targets[nextTarget])
+        {
+            reached[nextTarget] = point;
+            isReached[nextTarget] = true;
+            ++nextTarget;
+        }
+    }
+
+    for (size_t t = 0; t < config.targets.size(); ++t)
+    {
+        summary << Type::name() << "," << mode << "," << config.targets[t] << "," << (isReached[t] ? 1 : 0) << ",";
+        if (isReached[t])
+        {
+            summary << reached[t].iteration << "," << reached[t].wallSeconds << "," << reached[t].nodesTouched << "," << reached[t].exploitability;
+        }
+        else
+        {
+            summary << point.iteration << "," << point.wallSeconds << "," << point.nodesTouched << "," << point.exploitability;
+        }
+        summary << std::endl;
+    }
+}
+
+// main function
+int main(int argc, char *argv[])
+{
+    // parse arguments
+    cmdline::parser p;
+    p.add<std::string>("targets", 'e', "Comma-separated list of exploitability targets", false, "0.1,0.05,0.02,0.01,0.005,0.002,0.001");
+    p.add<std::string>("algorithms", 'a', "Comma-separated list of CFR variants to run", false, "standard,chance,external,outcome");
+    p.add<double>("max-time", 't', "Wall-time budget in seconds of each run, excluding evaluations", false, 30.0);
+    p.add<uint64_t>("max-iteration", 'i', "Iteration budget of each run", false, 100000000);
+    p.add<double>("eval-growth", 'g', "Factor by which the interval between exploitability evaluations grows", false, 1.1);
+    p.add<std::string>("output", 'o', "Path of the time-to-target CSV (default: standard output)", false, "");
+    p.add<std::string>("curve", 'c', "Path of a CSV receiving every exploitability evaluation", false, "");
+    p.add<uint32_t>("seed", 's', "Random seed used to initialize the random generators", false, 0);
+    p.add("incremental", 0, "Evaluate exploitability incrementally, recomputing only subtrees whose strategy changed");
+    p.add<double>("tolerance", 0, "L1 strategy change of an information set that triggers its recomputation in incremental evaluations", false, 0.0);
+    p.parse_check(argc, argv);
+
+    ConvergenceConfig config;
+    config.targets = parseTargets(p.get<std::string>("targets"));
+    config.maxSeconds = p.get<double>("max-time");
+    config.maxIterations = p.get<uint64_t>("max-iteration");
+    config.evalGrowth = std::max(1.0, p.get<double>("eval-growth"));
+    config.seed = p.get<uint32_t>("seed");
+    config.incremental = p.exist("incremental");
+    config.tolerance = p.get<double>("tolerance");
+
+    std::vector<std::string> algorithms;
+    std::stringstream ss(p.get<std::string>("algorithms"));
+    std::string algorithm;
+    const std::vector<std::string> knownAlgorithms = {"standard", "chance", "external", "outcome"};
+    while (std::getline(ss, algorithm, ','))
+    {
+        if (std::find(knownAlgorithms.begin(), knownAlgorithms.end(), algorithm) == knownAlgorithms.end())
+        {
+            std::cerr << "unknown algorithm \"" << algorithm << "\"" << std::endl;
+            return 1;
+        }
+        algorithms.push_back(algorithm);
+    }
+
+    std::ofstream summaryFile;
+    if (!p.get<std::string>("output").empty())
+    {
+        summaryFile.open(p.get<std::string>("output"));
+    }
+    std::ostream &summary = summaryFile.is_open() ? summaryFile : std::cout;
+    std::ofstream curveFile;
+    if (!p.get<std::string>("curve").empty())
+    {
+        curveFile.open(p.get<std::string>("curve"));
+        curveFile << "game,algorithm,iteration,wall_seconds,nodes_touched,exploitability\n";
+    }
+
+    // every built-in game is run with every requested algorithm
+    summary << "game,algorithm,target,reached,iteration,wall_seconds,nodes_touched,exploitability" << std::endl;
+    for (const std::string &mode : algorithms)
+    {
+        runConvergence<Kuhn::Game>(mode, config, summary, curveFile.is_open() ? &curveFile : nullptr);
+    }
+}
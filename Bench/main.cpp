@@ -0,0 +1,280 @@
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/serialization/unordered_map.hpp>
+#include "cmdline.h"
+#include "Allocation.hpp"
+#include "CFRAgent.hpp"
+#include "CFRAgent.cpp"
+#include "Game.hpp"
+#include "Node.hpp"
+#include "Trainer.hpp"
+#include "Trainer.cpp"
+
+// defines the game
+#define GAME Kuhn::Game
+
+// @brief Result of a single microbenchmark.
+struct BenchResult
+{
+    std::string name;      // Name of the measured operation.
+    uint64_t ops;          // Number of operations measured.
+    double nsPerOp;        // Wall time per operation in nanoseconds.
+    double nodesPerSecond; // Nodes touched per second, or 0 if the operation does not traverse the game tree.
+    double allocsPerOp;    // Heap allocations per operation.
+    double bytesPerOp;     // Heap bytes requested per operation.
+};
+
+// Accumulates results of measured operations so that the compiler cannot drop them.
+static volatile uint64_t benchSink = 0;
+
+// @brief Measures an operation by running it in doubling batches until the minimum time is reached.
+// @param name The name of the measured operation.
+// @param minSeconds The minimum wall time spent measuring.
+// @param op The operation; it returns the number of nodes touched by one call.
+// @return The measured result.
+static BenchResult measure(const std::string &name, const double minSeconds, const std::function<uint64_t()> &op)
+{
+    // warm up caches and lazily created state before measuring
+    for (int i = 0; i < 16; ++i)
+    {
+        op();
+    }
+
+    uint64_t ops = 0;
+    uint64_t nodes = 0;
+    double elapsed = 0.0;
+    const Metrics::AllocationStats before = Metrics::allocationStats();
+    for (uint64_t batch = 1; elapsed < minSeconds; batch *= 2)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < batch; ++i)
+        {
+            nodes += op();
+        }
+        elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ops += batch;
+    }
+    const Metrics::AllocationStats after = Metrics::allocationStats();
+
+    BenchResult result;
+    result.name = name;
+    result.ops = ops;
+    result.nsPerOp = elapsed * 1e9 / double(ops);
+    result.nodesPerSecond = double(nodes) / elapsed;
+    result.allocsPerOp = double(after.count - before.count) / double(ops);
+    result.bytesPerOp = double(after.bytes - before.bytes) / double(ops);
+    return result;
+}
+
+// @brief Writes the results as a JSON document.
+// @param os The output stream.
+// @param results The benchmark results.
+static void writeJson(std::ostream &os, const std::vector<BenchResult> &results)
+{
+    os << "{\n  \"game\": \"" << GAME::name() << "\",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchResult &r = results[i];
+        os << "    {\"name\": \"" << r.name << "\", \"ops\": " << r.ops << ", \"ns_per_op\": " << r.nsPerOp
+           << ", \"nodes_per_second\": " << r.nodesPerSecond << ", \"allocs_per_op\": " << r.allocsPerOp
+           << ", \"bytes_per_op\": " << r.bytesPerOp << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}" << std::endl;
+}
+
+// main function
+int main(int argc, char *argv[])
+{
+    // parse arguments
+    cmdline::parser p;
+    p.add<double>("min-time", 't', "Minimum wall time in seconds spent on each benchmark", false, 0.5);
+    p.add<int>("warmup", 'w', "Number of CFR iterations run before measuring trainer operations", false, 1000);
+    p.add<std::string>("output", 'o', "Path of the JSON report (default: standard output)", false, "");
+    p.add<uint32_t>("seed", 's', "Random seed used to initialize the random generators", false, 0);
+    p.add("check-zero-alloc", 0, "Exit with an error if a warm CFR iteration allocates heap memory");
+    p.parse_check(argc, argv);
+
+    const double minTime = p.get<double>("min-time");
+    const int warmup = p.get<int>("warmup");
+    const uint32_t seed = p.get<uint32_t>("seed");
+    std::vector<BenchResult> results;
+
+    // game primitives
+    std::mt19937 engine(seed);
+    GAME root(engine);
+    root.resetGame(false);
+    GAME decision(root);
+    decision.takeAction(0);
+    const int chanceActionNum = root.actionNum();
+
+    int deal = 0;
+    results.push_back(measure("game/takeAction", minTime, [&]()
+                              {
+                                  GAME game(root);
+                                  game.takeAction(deal++ % chanceActionNum);
+                                  game.takeAction(0);
+                                  game.takeAction(1);
+                                  game.takeAction(1);
+                                  benchSink += game.isGameOver();
+                                  return uint64_t(0); }));
+    results.push_back(measure("game/copy", minTime, [&]()
+                              {
+                                  GAME game(decision);
+                                  benchSink += game.currentPlayer();
+                                  return uint64_t(0); }));
+    results.push_back(measure("game/infoSetStr", minTime, [&]()
+                              {
+                                  benchSink += decision.infoSetStr().size();
+                                  return uint64_t(0); }));
+
+    // node primitives
+    Trainer::Node node(2);
+    double regret = 0.0;
+    results.push_back(measure("node/updateStrategy", minTime, [&]()
+                              {
+                                  regret += 1.0;
+                                  node.regretSum(0, regret);
+                                  node.regretSum(1, -regret);
+                                  node.updateStrategy();
+                                  benchSink += node.strategy()[0] > 0.5;
+                                  return uint64_t(0); }));
+
+    // one iteration of each CFR variant
+    const std::vector<std::string> modes = {"standard", "chance", "external", "outcome"};
+    for (const std::string &mode : modes)
+    {
+        Trainer::Trainer<GAME> trainer(mode, seed);
+        double utils[GAME::playerNum()];
+        int iteration = 0;
+        for (; iteration < warmup; ++iteration)
+        {
+            trainer.iterate(iteration, utils);
+        }
+        results.push_back(measure("cfr/" + mode, minTime, [&]()
+                                  {
+                                      const uint64_t touched = trainer.nodeTouchedCount();
+                                      trainer.iterate(iteration++, utils);
+                                      return trainer.nodeTouchedCount() - touched; }));
+    }
+
+    // node lookup and strategy evaluation on a warm standard trainer
+    Trainer::Trainer<GAME> trainer("standard", seed);
+    double utils[GAME::playerNum()];
+    for (int i = 0; i < warmup; ++i)
+    {
+        trainer.iterate(i, utils);
+    }
+    const std::unordered_map<std::string, Trainer::Node *> &nodeMap = trainer.nodeMap();
+    std::vector<std::string> keys;
+    for (auto &itr : nodeMap)
+    {
+        keys.push_back(itr.first);
+    }
+    size_t keyIndex = 0;
+    results.push_back(measure("trainer/nodeLookup", minTime, [&]()
+                              {
+                                  benchSink += nodeMap.find(keys[keyIndex++ % keys.size()])->second->actionNum();
+                                  return uint64_t(0); }));
+
+    std::vector<std::function<const double *(const GAME &)>> strategies(GAME::playerNum());
+    for (int i = 0; i < GAME::playerNum(); ++i)
+    {
+        strategies[i] = [&nodeMap](const GAME &game)
+        { return nodeMap.at(game.infoSetStr())->averageStrategy(); };
+    }
+    results.push_back(measure("eval/CalculatePayoff", minTime, [&]()
+                              {
+                                  benchSink += Trainer::Trainer<GAME>::CalculatePayoff(root, strategies)[0] > 0.0;
+                                  return uint64_t(0); }));
+    results.push_back(measure("eval/CalculateExploitability", minTime, [&]()
+                              {
+                                  benchSink += Trainer::Trainer<GAME>::CalculateExploitability(root, strategies) > 0.0;
+                                  return uint64_t(0); }));
+
+    // with unchanged strategies an incremental evaluation only compares the information set strategies
+    Trainer::IncrementalExploitability<GAME> incremental(root);
+    incremental.evaluate(strategies);
+    results.push_back(measure("eval/IncrementalExploitability/unchanged", minTime, [&]()
+                              {
+                                  benchSink += incremental.evaluate(strategies) > 0.0;
+                                  return uint64_t(0); }));
+
+    // agent queries, one at a time and batched, on the strategy of the warm trainer
+    const boost::filesystem::path strategyPath = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("grasp_bench_%%%%%%%%.bin");
+    {
+        std::ofstream ofs(strategyPath.string(), std::ios::binary);
+        boost::archive::binary_oarchive oa(ofs);
+        oa << nodeMap;
+    }
+    Agent::CFRAgent<GAME> agent(engine, strategyPath.string());
+    boost::filesystem::remove(strategyPath);
+    std::vector<GAME> states;
+    const std::function<void(const GAME &)> collect = [&](const GAME &game)
+    {
+        if (game.isGameOver())
+        {
+            return;
+        }
+        if (!game.isChanceNode())
+        {
+            states.push_back(game);
+        }
+        for (int a = 0; a < game.actionNum(); ++a)
+        {
+            GAME game_cp(game);
+            game_cp.takeAction(a);
+            collect(game_cp);
+        }
+    };
+    collect(root);
+    size_t stateIndex = 0;
+    results.push_back(measure("agent/chooseAction", minTime, [&]()
+                              {
+                                  benchSink += agent.chooseAction(states[stateIndex++ % states.size()]);
+                                  return uint64_t(0); }));
+    const size_t batchSize = 1024;
+    std::vector<std::string> batchKeys(batchSize);
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+        batchKeys[i] = states[i % states.size()].infoSetStr();
+    }
+    std::vector<int> batchActions(batchSize);
+    results.push_back(measure("agent/chooseActions/" + std::to_string(batchSize), minTime, [&]()
+                              {
+                                  agent.chooseActions(batchKeys.data(), batchSize, batchActions.data());
+                                  benchSink += batchActions[0];
+                                  return uint64_t(0); }));
+
+    // report
+    if (p.get<std::string>("output").empty())
+    {
+        writeJson(std::cout, results);
+    }
+    else
+    {
+        std::ofstream ofs(p.get<std::string>("output"));
+        writeJson(ofs, results);
+    }
+
+    // once the node table is warm, training iterations must not touch the heap
+    if (p.exist("check-zero-alloc"))
+    {
+        bool allocationFree = true;
+        for (const BenchResult &r : results)
+        {
+            if (r.name.compare(0, 4, "cfr/") == 0 && r.allocsPerOp > 0.0)
+            {
+                std::cerr << r.name << " allocates " << r.allocsPerOp << " times per iteration in steady state" << std::endl;
+                allocationFree = false;
+            }
+        }
+        return allocationFree ? 0 : 1;
+    }
+}
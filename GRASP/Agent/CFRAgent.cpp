@@ -1,39 +1,35 @@
 #include "CFRAgent.hpp"
-#include <fstream>
-#include <boost/archive/binary_iarchive.hpp>
-#include <boost/serialization/string.hpp>
-#include <boost/serialization/unordered_map.hpp>
+#include <algorithm>
+#include <future>
 
 namespace Agent
 {
-    // @brief Constructs a CFRAgent object, loading the strategy map from a file.
+    template <typename Type>
+    const size_t CFRAgent<Type>::BatchChunkSize;
+
+    // @brief Constructs a CFRAgent object, loading the strategy table from a file.
     // @param engine A reference to a Mersenne Twister pseudo-random number generator.
     // @param path The file path to the strategy file to load.
     template <typename Type>
-    CFRAgent<Type>::CFRAgent(std::mt19937 &engine, const std::string &path) : randomGenerator(engine)
+    CFRAgent<Type>::CFRAgent(std::mt19937 &engine, const std::string &path) : randomGenerator(engine), mCurrentStrategy(new StrategyTable(path))
     {
-        std::ifstream ifs(path);                 // Open the strategy file for input
-        boost::archive::binary_iarchive ia(ifs); // Create an input archive for deserialization
-        ia >> mCurrentStrategy;                  // Load the strategy map from the file
-        ifs.close();                             // Close the file stream
     }
 
-    // @brief Destructor for CFRAgent, responsible for cleaning up dynamically allocated memory.
+    // @brief Determines the action to be taken by the agent in a given game state.
+    // @param game The current state of the game.
+    // @return The action chosen by the agent based on the current strategy.
     template <typename Type>
-    CFRAgent<Type>::~CFRAgent()
+    int CFRAgent<Type>::chooseAction(const Type &game) const
     {
-        // Delete all dynamically allocated strategy nodes in the strategy map
-        for (auto &itr : mCurrentStrategy)
-        {
-            delete itr.second;
-        }
+        return chooseAction(game, randomGenerator);
     }
 
-    // @brief Determines the action to be taken by the agent in a given game state.
+    // @brief Samples the action to be taken in a given game state with the caller's random generator.
     // @param game The current state of the game.
-    // @return The action chosen by the agent based on the current strategy.
+    // @param generator The random generator of the calling thread.
+    // @return The action chosen by the agent.
     template <typename Type>
-    int CFRAgent<Type>::chooseAction(const Type &game) const
+    int CFRAgent<Type>::chooseAction(const Type &game, std::mt19937 &generator) const
     {
         // If there is only one possible action, return 0 (no choice needed)
         if (game.actionNum() == 1)
@@ -41,15 +37,12 @@ namespace Agent
             return 0;
         }
 
-        // Retrieve the information set string representation for the current game state
-        const std::string infoSetStr = game.infoSetStr();
+        // Retrieve the strategy row for the information set of the current game state
+        const StrategySlot::Reader table(mCurrentStrategy);
+        const int row = table->at(game.infoSetStr());
 
-        // Retrieve the average strategy for this information set
-        const double *probability = mCurrentStrategy.at(infoSetStr)->averageStrategy();
-
-        // Use a discrete distribution to randomly select an action based on the strategy probabilities
-        std::discrete_distribution<int> dist(probability, probability + game.actionNum());
-        return dist(randomGenerator);
+        // Sample from the precomputed alias table of the row with a single uniform draw
+        return table->sample(row, double(generator()) / 4294967296.0);
     }
 
     // @brief Retrieves the strategy for the agent in a given game state.
@@ -59,6 +52,152 @@ namespace Agent
     const double *CFRAgent<Type>::strategy(const Type &game) const
     {
         // Retrieve the strategy probabilities for the current game state
-        return mCurrentStrategy.at(game.infoSetStr())->averageStrategy();
+        const StrategySlot::Reader table(mCurrentStrategy);
+        return table->probability(table->at(game.infoSetStr()));
+    }
+
+    // @brief Retrieves the strategies for a batch of game states.
+    // @param games The game states, each at a decision of a player.
+    // @param count The number of game states.
+    // @param rows The output array receiving a pointer to the strategy probabilities of each state.
+    template <typename Type>
+    void CFRAgent<Type>::strategies(const Type *games, const size_t count, const double **rows) const
+    {
+        const StrategySlot::Reader table(mCurrentStrategy);
+        for (size_t i = 0; i < count; ++i)
+        {
+            rows[i] = table->probability(table->at(games[i].infoSetStr()));
+        }
+    }
+
+    // @brief Retrieves the strategies for a batch of information sets.
+    // @param infoSetStrs The information set keys, as returned by Type::infoSetStr.
+    // @param count The number of keys.
+    // @param rows The output array receiving a pointer to the strategy probabilities of each information set.
+    // @param actionNums An optional output array receiving the number of actions of each information set.
+    template <typename Type>
+    void CFRAgent<Type>::strategies(const std::string *infoSetStrs, const size_t count, const double **rows, int *actionNums) const
+    {
+        const StrategySlot::Reader table(mCurrentStrategy);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const int row = table->at(infoSetStrs[i]);
+            rows[i] = table->probability(row);
+            if (actionNums != nullptr)
+            {
+                actionNums[i] = table->actionNum(row);
+            }
+        }
+    }
+
+    // @brief Samples actions for a batch of game states.
+    // @param games The game states, each at a decision of a player.
+    // @param count The number of game states.
+    // @param actions The output array receiving the action chosen in each state.
+    template <typename Type>
+    void CFRAgent<Type>::chooseActions(const Type *games, const size_t count, int *actions) const
+    {
+        chooseActions(games, count, actions, randomGenerator);
+    }
+
+    // @brief Samples actions for a batch of game states with the caller's random generator.
+    // @param games The game states, each at a decision of a player.
+    // @param count The number of game states.
+    // @param actions The output array receiving the action chosen in each state.
+    // @param generator The random generator of the calling thread.
+    template <typename Type>
+    void CFRAgent<Type>::chooseActions(const Type *games, const size_t count, int *actions, std::mt19937 &generator) const
+    {
+        // the lookups of a chunk are resolved before any sampling, so the sampling loop only touches the strategy rows
+        const StrategySlot::Reader table(mCurrentStrategy);
+        int rows[BatchChunkSize];
+        for (size_t begin = 0; begin < count; begin += BatchChunkSize)
+        {
+            const size_t size = std::min(count - begin, BatchChunkSize);
+            for (size_t i = 0; i < size; ++i)
+            {
+                rows[i] = table->at(games[begin + i].infoSetStr());
+            }
+            sampleActions(*table, rows, size, actions + begin, generator);
+        }
+    }
+
+    // @brief Samples actions for a batch of information sets.
+    // @param infoSetStrs The information set keys, as returned by Type::infoSetStr.
+    // @param count The number of keys.
+    // @param actions The output array receiving the action chosen at each information set.
+    template <typename Type>
+    void CFRAgent<Type>::chooseActions(const std::string *infoSetStrs, const size_t count, int *actions) const
+    {
+        chooseActions(infoSetStrs, count, actions, randomGenerator);
+    }
+
+    // @brief Samples actions for a batch of information sets with the caller's random generator.
+    // @param infoSetStrs The information set keys, as returned by Type::infoSetStr.
+    // @param count The number of keys.
+    // @param actions The output array receiving the action chosen at each information set.
+    // @param generator The random generator of the calling thread.
+    template <typename Type>
+    void CFRAgent<Type>::chooseActions(const std::string *infoSetStrs, const size_t count, int *actions, std::mt19937 &generator) const
+    {
+        const StrategySlot::Reader table(mCurrentStrategy);
+        int rows[BatchChunkSize];
+        for (size_t begin = 0; begin < count; begin += BatchChunkSize)
+        {
+            const size_t size = std::min(count - begin, BatchChunkSize);
+            for (size_t i = 0; i < size; ++i)
+            {
+                rows[i] = table->at(infoSetStrs[begin + i]);
+            }
+            sampleActions(*table, rows, size, actions + begin, generator);
+        }
+    }
+
+    // @brief Loads a strategy file and makes it the agent's strategy once it is ready.
+    // @param path The file path to the strategy file to load.
+    template <typename Type>
+    void CFRAgent<Type>::reload(const std::string &path)
+    {
+        // queries keep being answered from the current table while the new one is built
+        mCurrentStrategy.swap(new StrategyTable(path));
+    }
+
+    // @brief Loads a strategy file on a background thread and makes it the agent's strategy once it is ready.
+    // @param path The file path to the strategy file to load.
+    // @return A future that becomes ready after the switch, or holds the exception raised while loading.
+    template <typename Type>
+    std::future<void> CFRAgent<Type>::reloadAsync(const std::string &path)
+    {
+        return std::async(std::launch::async, [this, path]()
+                          { reload(path); });
+    }
+
+    // @brief Returns the number of strategy reloads performed so far.
+    // @return The generation of the strategy being served.
+    template <typename Type>
+    uint64_t CFRAgent<Type>::generation() const
+    {
+        return mCurrentStrategy.generation();
+    }
+
+    // @brief Samples one action per strategy row from the row's alias table.
+    // @param table The strategy table holding the rows.
+    // @param rows The strategy rows.
+    // @param count The number of rows.
+    // @param actions The output array receiving the sampled actions.
+    // @param generator The random generator drawing the uniform numbers.
+    template <typename Type>
+    void CFRAgent<Type>::sampleActions(const StrategyTable &table, const int *rows, const size_t count, int *actions, std::mt19937 &generator) const
+    {
+        // draw every uniform of the chunk in one pass, then sample each row without touching the generator
+        double uniforms[BatchChunkSize];
+        for (size_t i = 0; i < count; ++i)
+        {
+            uniforms[i] = double(generator()) / 4294967296.0;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            actions[i] = table.sample(rows[i], uniforms[i]);
+        }
     }
-}
\ No newline at end of file
+}
@@ -1,14 +1,23 @@
 #ifndef GRASP_CFRAGENT_HPP
 #define GRASP_CFRAGENT_HPP
 
+#include <cstddef>
+#include <cstdint>
+#include <future>
 #include <random>
 #include <string>
-#include <unordered_map>
-#include "Node.hpp"
+#include "StrategySlot.hpp"
+#include "StrategyTable.hpp"
 
 namespace Agent
 {
     // @brief Implements a Counterfactual Regret Minimization (CFR) agent for a given game.
+    // @details The strategy is loaded into an immutable table when the agent is constructed, so every query only reads
+    //          shared memory. The overloads taking a random generator can therefore be called from any number of threads
+    //          at once, each passing its own generator; the other sampling overloads draw from the generator given at
+    //          construction and must not be called concurrently. A new strategy file can be loaded while the agent
+    //          serves queries; each query, or batch, is answered entirely from the table current when it started.
+    //          Strategy rows returned by strategy() and strategies() stay valid until the second reload after the call.
     // @tparam Type The game type for which this agent is designed.
     template <typename Type>
     class CFRAgent
@@ -19,22 +28,86 @@ namespace Agent
         // @param strategyFilePath The file path to the strategy file to load or save.
         explicit CFRAgent(std::mt19937 &generator, const std::string &strategyFilePath);
 
-        // @brief Destructor for CFRAgent, responsible for cleanup.
-        ~CFRAgent();
-
         // @brief Determines the chooseAction to be taken by the agent in a given game state.
         // @param game The current state of the game.
         // @return The chooseAction chosen by the agent.
         int chooseAction(const Type &game) const;
 
+        // @brief Samples the action to be taken in a given game state with the caller's random generator.
+        // @param game The current state of the game.
+        // @param generator The random generator of the calling thread.
+        // @return The action chosen by the agent.
+        int chooseAction(const Type &game, std::mt19937 &generator) const;
+
         // @brief Retrieves the strategy for the agent in a given game state.
         // @param game The current state of the game.
         // @return A pointer to an array representing the strategy probabilities.
         const double *strategy(const Type &game) const;
 
+        // @brief Retrieves the strategies for a batch of game states.
+        // @param games The game states, each at a decision of a player.
+        // @param count The number of game states.
+        // @param rows The output array receiving a pointer to the strategy probabilities of each state.
+        void strategies(const Type *games, size_t count, const double **rows) const;
+
+        // @brief Retrieves the strategies for a batch of information sets.
+        // @param infoSetStrs The information set keys, as returned by Type::infoSetStr.
+        // @param count The number of keys.
+        // @param rows The output array receiving a pointer to the strategy probabilities of each information set.
+        // @param actionNums An optional output array receiving the number of actions of each information set.
+        void strategies(const std::string *infoSetStrs, size_t count, const double **rows, int *actionNums = nullptr) const;
+
+        // @brief Samples actions for a batch of game states.
+        // @param games The game states, each at a decision of a player.
+        // @param count The number of game states.
+        // @param actions The output array receiving the action chosen in each state.
+        void chooseActions(const Type *games, size_t count, int *actions) const;
+
+        // @brief Samples actions for a batch of game states with the caller's random generator.
+        // @param games The game states, each at a decision of a player.
+        // @param count The number of game states.
+        // @param actions The output array receiving the action chosen in each state.
+        // @param generator The random generator of the calling thread.
+        void chooseActions(const Type *games, size_t count, int *actions, std::mt19937 &generator) const;
+
+        // @brief Samples actions for a batch of information sets.
+        // @param infoSetStrs The information set keys, as returned by Type::infoSetStr.
+        // @param count The number of keys.
+        // @param actions The output array receiving the action chosen at each information set.
+        void chooseActions(const std::string *infoSetStrs, size_t count, int *actions) const;
+
+        // @brief Samples actions for a batch of information sets with the caller's random generator.
+        // @param infoSetStrs The information set keys, as returned by Type::infoSetStr.
+        // @param count The number of keys.
+        // @param actions The output array receiving the action chosen at each information set.
+        // @param generator The random generator of the calling thread.
+        void chooseActions(const std::string *infoSetStrs, size_t count, int *actions, std::mt19937 &generator) const;
+
+        // @brief Loads a strategy file and makes it the agent's strategy once it is ready.
+        // @param path The file path to the strategy file to load.
+        void reload(const std::string &path);
+
+        // @brief Loads a strategy file on a background thread and makes it the agent's strategy once it is ready.
+        // @param path The file path to the strategy file to load.
+        // @return A future that becomes ready after the switch, or holds the exception raised while loading.
+        std::future<void> reloadAsync(const std::string &path);
+
+        // @brief Returns the number of strategy reloads performed so far.
+        // @return The generation of the strategy being served.
+        uint64_t generation() const;
+
     private:
-        std::mt19937 &randomGenerator;                                     // Reference to the random number generator used by the agent.
-        std::unordered_map<std::string, Trainer::Node *> mCurrentStrategy; // Map storing the strategy nodes indexed by game state information.
+        // @brief Samples one action per strategy row from the row's alias table.
+        // @param table The strategy table holding the rows.
+        // @param rows The strategy rows.
+        // @param count The number of rows.
+        // @param actions The output array receiving the sampled actions.
+        // @param generator The random generator drawing the uniform numbers.
+        void sampleActions(const StrategyTable &table, const int *rows, size_t count, int *actions, std::mt19937 &generator) const;
+
+        static const size_t BatchChunkSize = 256; // Number of queries of a batch resolved and sampled together.
+        std::mt19937 &randomGenerator;            // Reference to the random number generator used by the agent.
+        StrategySlot mCurrentStrategy;            // Average strategies with their alias tables, swapped on reload.
     };
 }
 
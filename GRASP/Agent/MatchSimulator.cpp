@@ -0,0 +1,285 @@
+#include "MatchSimulator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace Agent
+{
+    // @brief Constructs a simulator.
+    // @param agents One agent per seat; the agents must outlive the simulator.
+    // @param threadNum The number of threads.
+    // @param seed The seed of the random generators; thread t uses seed + t.
+    template <typename Type>
+    MatchSimulator<Type>::MatchSimulator(const std::vector<const CFRAgent<Type> *> &agents, const int threadNum, const uint32_t seed)
+        : mAgents(agents), mThreadNum(std::max(1, threadNum)), mSeed(seed), mDuplicate(false), mControlVariates(false)
+    {
+    }
+
+    // @brief Plays a match.
+    // @param hands The number of hands to play.
+    // @return The outcome for each agent.
+    template <typename Type>
+    MatchResult MatchSimulator<Type>::play(const uint64_t hands) const
+    {
+        const int playerNum = Type::playerNum();
+        const auto start = std::chrono::steady_clock::now();
+
+        // a deal is one sample: a single hand, or in duplicate mode one hand per seat rotation
+        const int rotations = mDuplicate ? playerNum : 1;
+        const uint64_t deals = (hands + uint64_t(rotations) - 1) / uint64_t(rotations);
+
+        // per-thread sums, laid out so that threads never write to the same cache line
+        const int stride = 8 * playerNum + 8;
+        std::vector<double> sums(size_t(mThreadNum) * stride, 0.0);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < mThreadNum; ++t)
+        {
+            workers.emplace_back([&, t]()
+                                 {
+                                     std::mt19937 engine(mSeed + uint32_t(t));
+                                     std::mt19937 dealEngine(engine()), dealStart;
+                                     Type root(dealEngine);
+                                     double *sum = sums.data() + size_t(t) * stride;
+                                     int seating[playerNum];
+                                     double payoffs[playerNum], dealPayoffs[playerNum], dealWins[playerNum];
+                                     double corrected[playerNum], dealCorrected[playerNum];
+                                     for (uint64_t d = uint64_t(t); d < deals; d += uint64_t(mThreadNum))
+                                     {
+                                         if (mDuplicate)
+                                         {
+                                             dealStart = dealEngine;
+                                         }
+                                         for (int a = 0; a < playerNum; ++a)
+                                         {
+                                             dealPayoffs[a] = 0.0;
+                                             dealWins[a] = 0.0;
+                                             dealCorrected[a] = 0.0;
+                                         }
+                                         for (int r = 0; r < rotations; ++r)
+                                         {
+                                             // every rotation of a duplicate deal replays the same chance outcomes
+                                             if (mDuplicate && r > 0)
+                                             {
+                                                 dealEngine = dealStart;
+                                             }
+                                             // agent a sits at (a + offset) mod playerNum
+                                             const uint64_t offset = mDuplicate ? uint64_t(r) : d;
+                                             for (int a = 0; a < playerNum; ++a)
+                                             {
+                                                 seating[(a + offset) % playerNum] = a;
+                                             }
+                                             playHand(root, seating, dealEngine, engine, payoffs, mControlVariates ? corrected : nullptr);
+                                             for (int a = 0; a < playerNum; ++a)
+                                             {
+                                                 dealPayoffs[a] += payoffs[a] / double(rotations);
+                                                 dealWins[a] += (payoffs[a] > 0.0 ? 1.0 : 0.0) / double(rotations);
+                                                 sum[3 * playerNum + a] += payoffs[a];
+                                                 sum[4 * playerNum + a] += payoffs[a] * payoffs[a];
+                                                 if (mControlVariates)
+                                                 {
+                                                     dealCorrected[a] += corrected[a] / double(rotations);
+                                                 }
+                                             }
+                                         }
+                                         for (int a = 0; a < playerNum; ++a)
+                                         {
+                                             sum[a] += dealPayoffs[a];
+                                             sum[playerNum + a] += dealPayoffs[a] * dealPayoffs[a];
+                                             sum[2 * playerNum + a] += dealWins[a];
+                                             sum[5 * playerNum + a] += dealWins[a] * dealWins[a];
+                                             sum[6 * playerNum + a] += dealCorrected[a];
+                                             sum[7 * playerNum + a] += dealCorrected[a] * dealCorrected[a];
+                                         }
+                                     } });
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+
+        MatchResult result;
+        result.hands = deals * uint64_t(rotations);
+        result.deals = deals;
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double n = double(std::max<uint64_t>(deals, 1)), handNum = double(std::max<uint64_t>(result.hands, 1));
+        for (int a = 0; a < playerNum; ++a)
+        {
+            double sum = 0.0, square = 0.0, wins = 0.0, winSquare = 0.0, handSum = 0.0, handSquare = 0.0;
+            for (int t = 0; t < mThreadNum; ++t)
+            {
+                const double *threadSum = sums.data() + size_t(t) * stride;
+                sum += threadSum[a];
+                square += threadSum[playerNum + a];
+                wins += threadSum[2 * playerNum + a];
+                handSum += threadSum[3 * playerNum + a];
+                handSquare += threadSum[4 * playerNum + a];
+                winSquare += threadSum[5 * playerNum + a];
+            }
+            const double mean = sum / n;
+            const double variance = deals > 1 ? std::max(0.0, (square - n * mean * mean) / (n - 1.0)) : 0.0;
+            const double handMean = handSum / handNum;
+            const double handVariance = result.hands > 1 ? std::max(0.0, (handSquare - handNum * handMean * handMean) / (handNum - 1.0)) : 0.0;
+            result.payoff.push_back(mean);
+            result.stdErr.push_back(std::sqrt(variance / n));
+            result.unpairedStdErr.push_back(std::sqrt(handVariance / handNum));
+
+            // win indicators of a duplicate deal are averaged like the payoffs, so their variance is estimated the same way
+            const double winRate = wins / n;
+            const double winVariance = deals > 1 ? std::max(0.0, (winSquare - n * winRate * winRate) / (n - 1.0)) : 0.0;
+            result.winRate.push_back(winRate);
+            result.winErr.push_back(std::sqrt(winVariance / n));
+
+            if (mControlVariates)
+            {
+                double correctedSum = 0.0, correctedSquare = 0.0;
+                for (int t = 0; t < mThreadNum; ++t)
+                {
+                    const double *threadSum = sums.data() + size_t(t) * stride;
+                    correctedSum += threadSum[6 * playerNum + a];
+                    correctedSquare += threadSum[7 * playerNum + a];
+                }
+                const double correctedMean = correctedSum / n;
+                const double correctedVariance = deals > 1 ? std::max(0.0, (correctedSquare - n * correctedMean * correctedMean) / (n - 1.0)) : 0.0;
+                result.correctedPayoff.push_back(correctedMean);
+                result.correctedStdErr.push_back(std::sqrt(correctedVariance / n));
+            }
+        }
+        return result;
+    }
+
+    // @brief Enables or disables duplicate deals.
+    // @param duplicate True to replay every deal with the seats rotated.
+    template <typename Type>
+    void MatchSimulator<Type>::setDuplicate(const bool duplicate)
+    {
+        mDuplicate = duplicate;
+    }
+
+    // @brief Enables or disables the control-variate correction of the payoffs.
+    // @param controlVariates True to report corrected payoffs as well.
+    template <typename Type>
+    void MatchSimulator<Type>::setControlVariates(const bool controlVariates)
+    {
+        mControlVariates = controlVariates;
+    }
+
+    // @brief Plays one hand to the end.
+    // @param root A state whose resetGame() deals a new hand from the deal generator.
+    // @param seating The agent sitting in each seat.
+    // @param dealEngine The random generator of the deal and the later chance outcomes.
+    // @param engine The random generator of the agents' decisions.
+    // @param payoffs Receives the payoff of each agent.
+    // @param corrected Receives the corrected payoff of each agent, or nullptr to skip the correction.
+    template <typename Type>
+    void MatchSimulator<Type>::playHand(const Type &root, const int *seating, std::mt19937 &dealEngine, std::mt19937 &engine, double *payoffs, double *corrected) const
+    {
+        const int playerNum = Type::playerNum();
+        int seatOf[playerNum];
+        for (int p = 0; p < playerNum; ++p)
+        {
+            seatOf[seating[p]] = p;
+        }
+
+        // the correction needs the deal as a chance node, so it is not skipped then
+        auto game(root);
+        game.resetGame(corrected == nullptr);
+        if (corrected != nullptr)
+        {
+            for (int a = 0; a < playerNum; ++a)
+            {
+                corrected[a] = 0.0;
+            }
+        }
+        while (!game.isGameOver())
+        {
+            const int actionNum = game.actionNum();
+            int action = 0;
+            const double *probability = nullptr;
+            if (game.isChanceNode())
+            {
+                // chance outcomes are sampled from their probabilities
+                double r = std::uniform_real_distribution<double>(0.0, 1.0)(dealEngine);
+                for (; action < actionNum - 1; ++action)
+                {
+                    auto game_cp(game);
+                    game_cp.takeAction(action);
+                    r -= game_cp.chanceProbability();
+                    if (r < 0.0)
+                    {
+                        break;
+                    }
+                }
+            }
+            else
+            {
+                const CFRAgent<Type> &agent = *mAgents[seating[game.currentPlayer()]];
+                action = agent.chooseAction(game, engine);
+                if (corrected != nullptr && actionNum > 1)
+                {
+                    probability = agent.strategy(game);
+                }
+            }
+
+            // every agent subtracts the value of the outcome taken and adds back its expectation
+            if (corrected != nullptr && actionNum > 1)
+            {
+                for (int a = 0; a < playerNum; ++a)
+                {
+                    double expected = 0.0, taken = 0.0;
+                    for (int b = 0; b < actionNum; ++b)
+                    {
+                        auto game_cp(game);
+                        game_cp.takeAction(b);
+                        const double value = Value(game_cp, *mAgents[a], seatOf[a]);
+                        expected += (probability != nullptr ? probability[b] : game_cp.chanceProbability()) * value;
+                        if (b == action)
+                        {
+                            taken = value;
+                        }
+                    }
+                    corrected[a] += expected - taken;
+                }
+            }
+            game.takeAction(action);
+        }
+        for (int p = 0; p < playerNum; ++p)
+        {
+            payoffs[seating[p]] = game.payoff(p);
+            if (corrected != nullptr)
+            {
+                corrected[seating[p]] += game.payoff(p);
+            }
+        }
+    }
+
+    // @brief Computes the expected payoff of a state when one agent's strategy plays every seat.
+    // @param game The state.
+    // @param agent The agent.
+    // @param player The seat whose payoff is returned.
+    // @return The expected payoff.
+    template <typename Type>
+    double MatchSimulator<Type>::Value(const Type &game, const CFRAgent<Type> &agent, const int player)
+    {
+        if (game.isGameOver())
+        {
+            return game.payoff(player);
+        }
+        const int actionNum = game.actionNum();
+        if (actionNum == 1)
+        {
+            auto game_cp(game);
+            game_cp.takeAction(0);
+            return Value(game_cp, agent, player);
+        }
+        const double *probability = game.isChanceNode() ? nullptr : agent.strategy(game);
+        double value = 0.0;
+        for (int a = 0; a < actionNum; ++a)
+        {
+            auto game_cp(game);
+            game_cp.takeAction(a);
+            value += (probability != nullptr ? probability[a] : game_cp.chanceProbability()) * Value(game_cp, agent, player);
+        }
+        return value;
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef GRASP_MATCHSIMULATOR_HPP
+#define GRASP_MATCHSIMULATOR_HPP
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "CFRAgent.hpp"
+
+namespace Agent
+{
+    // @brief Outcome of a simulated match for each agent.
+    struct MatchResult
+    {
+        uint64_t hands;                      // Number of hands played.
+        uint64_t deals;                      // Number of independent deals; each is played once per seating in duplicate mode.
+        double seconds;                      // Wall time of the simulation.
+        std::vector<double> payoff;          // Mean payoff per hand of each agent.
+        std::vector<double> stdErr;          // Standard error of each mean payoff, from the per-deal outcomes.
+        std::vector<double> unpairedStdErr;  // Standard error the same hands would give if their deals were independent.
+        std::vector<double> winRate;         // Fraction of hands with a positive payoff for each agent.
+        std::vector<double> winErr;          // Standard error of each win rate, from the per-deal outcomes.
+        std::vector<double> correctedPayoff; // Mean control-variate corrected payoff per hand of each agent; empty unless enabled.
+        std::vector<double> correctedStdErr; // Standard error of each corrected mean payoff, from the per-deal outcomes.
+    };
+
+    // @brief Plays agents against each other over many sampled hands on several threads.
+    // @details Every thread owns a random generator seeded from the simulator's seed and plays a disjoint share of the
+    //          hands. Seats rotate from hand to hand, so every agent plays every seat equally often and positional
+    //          advantages cancel out of the means. In duplicate mode every deal is replayed once per seat rotation with
+    //          the same chance outcomes (common random numbers), and the average over the rotations is one paired
+    //          sample: the luck of the cards cancels within the pair, which shrinks the standard error for the same
+    //          number of hands. With control variates (in the spirit of AIVAT) every agent's payoff is corrected at
+    //          every chance node and every decision by the difference between the value of the outcome taken and the
+    //          expected value over all outcomes, both valued by the agent's own strategy playing every seat. Outcomes
+    //          are drawn from the probabilities the expectation uses, so each correction has zero mean and the corrected
+    //          payoff stays an unbiased estimate, while the part of the payoff the values predict no longer adds noise.
+    //          The values are computed by traversing the subtree below every child, which suits small games.
+    // @tparam Type The type of game being played.
+    template <typename Type>
+    class MatchSimulator
+    {
+    public:
+        // @brief Constructs a simulator.
+        // @param agents One agent per seat; the agents must outlive the simulator.
+        // @param threadNum The number of threads.
+        // @param seed The seed of the random generators; thread t uses seed + t.
+        MatchSimulator(const std::vector<const CFRAgent<Type> *> &agents, int threadNum, uint32_t seed);
+
+        // @brief Plays a match.
+        // @param hands The number of hands to play.
+        // @return The outcome for each agent.
+        MatchResult play(uint64_t hands) const;
+
+        // @brief Enables or disables duplicate deals.
+        // @param duplicate True to replay every deal with the seats rotated.
+        void setDuplicate(bool duplicate);
+
+        // @brief Enables or disables the control-variate correction of the payoffs.
+        // @param controlVariates True to report corrected payoffs as well.
+        void setControlVariates(bool controlVariates);
+
+    private:
+        // @brief Plays one hand to the end.
+        // @param root A state whose resetGame() deals a new hand from the deal generator.
+        // @param seating The agent sitting in each seat.
+        // @param dealEngine The random generator of the deal and the later chance outcomes.
+        // @param engine The random generator of the agents' decisions.
+        // @param payoffs Receives the payoff of each agent.
+        // @param corrected Receives the corrected payoff of each agent, or nullptr to skip the correction.
+        void playHand(const Type &root, const int *seating, std::mt19937 &dealEngine, std::mt19937 &engine, double *payoffs, double *corrected) const;
+
+        // @brief Computes the expected payoff of a state when one agent's strategy plays every seat.
+        // @param game The state.
+        // @param agent The agent.
+        // @param player The seat whose payoff is returned.
+        // @return The expected payoff.
+        static double Value(const Type &game, const CFRAgent<Type> &agent, int player);
+
+        std::vector<const CFRAgent<Type> *> mAgents; // Agents taking part, one per seat.
+        int mThreadNum;                              // Number of threads.
+        uint32_t mSeed;                              // Seed of the random generators.
+        bool mDuplicate;                             // Flag indicating if every deal is replayed with the seats rotated.
+        bool mControlVariates;                       // Flag indicating if the payoffs are corrected by control variates.
+    };
+}
+
+#endif
@@ -0,0 +1,85 @@
+#include "StrategySlot.hpp"
+#include <thread>
+
+namespace Agent
+{
+    // @brief Registers a reader of the current table.
+    // @param slot The slot to read.
+    StrategySlot::Reader::Reader(const StrategySlot &slot) : mSlot(slot)
+    {
+        // a swap to the other parity may slip in between the load and the registration; the re-check catches it
+        while (true)
+        {
+            const uint64_t generation = slot.mGeneration.load();
+            mParity = int(generation & 1);
+            slot.mReaders[mParity].count.fetch_add(1);
+            if (slot.mGeneration.load() == generation)
+            {
+                break;
+            }
+            slot.mReaders[mParity].count.fetch_sub(1);
+        }
+        mTable = slot.mTables[mParity];
+    }
+
+    // @brief Unregisters the reader.
+    StrategySlot::Reader::~Reader()
+    {
+        mSlot.mReaders[mParity].count.fetch_sub(1);
+    }
+
+    // @brief Accesses the table current at registration.
+    // @return A pointer to the table.
+    const StrategyTable *StrategySlot::Reader::operator->() const
+    {
+        return mTable;
+    }
+
+    // @brief Accesses the table current at registration.
+    // @return A reference to the table.
+    const StrategyTable &StrategySlot::Reader::operator*() const
+    {
+        return *mTable;
+    }
+
+    // @brief Constructs a slot serving the given table.
+    // @param table The initial table; the slot takes ownership.
+    StrategySlot::StrategySlot(const StrategyTable *table) : mTables{table, nullptr}, mGeneration(0)
+    {
+        mReaders[0].count = 0;
+        mReaders[1].count = 0;
+    }
+
+    // @brief Frees the tables held by the slot. No reader may be registered.
+    StrategySlot::~StrategySlot()
+    {
+        delete mTables[0];
+        delete mTables[1];
+    }
+
+    // @brief Makes a new table current, freeing the table two generations old once its readers have left.
+    // @param table The new table; the slot takes ownership.
+    void StrategySlot::swap(const StrategyTable *table)
+    {
+        std::lock_guard<std::mutex> lock(mSwapMutex);
+        const uint64_t generation = mGeneration.load();
+        const int parity = int((generation + 1) & 1);
+
+        // readers registered on the other parity hold the table two generations old; new readers cannot register
+        // there until the generation advances
+        while (mReaders[parity].count.load() != 0)
+        {
+            std::this_thread::yield();
+        }
+        delete mTables[parity];
+        mTables[parity] = table;
+        mGeneration.store(generation + 1);
+    }
+
+    // @brief Returns the number of swaps performed so far.
+    // @return The generation of the current table.
+    uint64_t StrategySlot::generation() const
+    {
+        return mGeneration.load();
+    }
+}
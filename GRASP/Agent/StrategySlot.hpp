@@ -0,0 +1,85 @@
+#ifndef GRASP_STRATEGYSLOT_HPP
+#define GRASP_STRATEGYSLOT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include "StrategyTable.hpp"
+
+namespace Agent
+{
+    // @brief Holds the strategy table served by an agent and replaces it without blocking readers.
+    // @details Tables alternate between two slots, one per generation parity. A reader registers in the counter of the
+    //          current generation's slot and re-checks the generation, so it never waits. A swap installs the new
+    //          table in the other slot and advances the generation; the table it displaces there, which is two
+    //          generations old, is freed once the readers that registered on it have left. The table being replaced
+    //          therefore stays valid for one more generation, which lets in-flight queries finish on it.
+    class StrategySlot
+    {
+    public:
+        // @brief Registers a reader of the current table for its lifetime.
+        class Reader
+        {
+        public:
+            // @brief Registers a reader of the current table.
+            // @param slot The slot to read.
+            explicit Reader(const StrategySlot &slot);
+
+            // @brief Unregisters the reader.
+            ~Reader();
+
+            Reader(const Reader &) = delete;
+            Reader &operator=(const Reader &) = delete;
+
+            // @brief Accesses the table current at registration.
+            // @return A pointer to the table.
+            const StrategyTable *operator->() const;
+
+            // @brief Accesses the table current at registration.
+            // @return A reference to the table.
+            const StrategyTable &operator*() const;
+
+        private:
+            const StrategySlot &mSlot;   // Slot being read.
+            int mParity;                 // Parity of the generation registered on.
+            const StrategyTable *mTable; // Table current at registration.
+        };
+
+        // @brief Constructs a slot serving the given table.
+        // @param table The initial table; the slot takes ownership.
+        explicit StrategySlot(const StrategyTable *table);
+
+        // @brief Frees the tables held by the slot. No reader may be registered.
+        ~StrategySlot();
+
+        StrategySlot(const StrategySlot &) = delete;
+        StrategySlot &operator=(const StrategySlot &) = delete;
+
+        // @brief Makes a new table current, freeing the table two generations old once its readers have left.
+        // @param table The new table; the slot takes ownership.
+        void swap(const StrategyTable *table);
+
+        // @brief Returns the number of swaps performed so far.
+        // @return The generation of the current table.
+        uint64_t generation() const;
+
+    private:
+        // @brief A reader counter on its own cache line, so that readers of one parity do not slow down the other.
+        // @details The counter is padded on both sides rather than over-aligned: C++14 operator new ignores extended
+        //          alignment, and agents holding a slot are allocated with new. A line holding the counter can then
+        //          hold no other member, wherever the slot starts.
+        struct ReaderCount
+        {
+            char before[64 - sizeof(std::atomic<uint64_t>)]; // Padding separating the counter from the previous member.
+            std::atomic<uint64_t> count;                     // Number of readers registered on the parity.
+            char after[64 - sizeof(std::atomic<uint64_t>)];  // Padding separating the counter from the next member.
+        };
+
+        const StrategyTable *mTables[2];   // Tables of the current and the previous generation, indexed by parity.
+        mutable ReaderCount mReaders[2];   // Registered readers, indexed by parity.
+        std::atomic<uint64_t> mGeneration; // Number of swaps performed; its parity selects the current table.
+        std::mutex mSwapMutex;             // Serializes swaps; readers never take it.
+    };
+}
+
+#endif
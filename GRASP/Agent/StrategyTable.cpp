@@ -0,0 +1,173 @@
+#include "StrategyTable.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/serialization/string.hpp>
+#include <boost/serialization/unordered_map.hpp>
+#include "MemoryReport.hpp"
+
+namespace Agent
+{
+    // @brief Loads a strategy file written by Trainer::writeStrategyToBin.
+    // @param path The path of the strategy file.
+    StrategyTable::StrategyTable(const std::string &path)
+    {
+        std::unordered_map<std::string, Trainer::Node *> nodes;
+        std::ifstream ifs(path, std::ios::binary);
+        boost::archive::binary_iarchive ia(ifs);
+        ia >> nodes;
+        ifs.close();
+
+        // the nodes are only needed until their average strategies are copied
+        mIndex.reserve(nodes.size());
+        for (auto &itr : nodes)
+        {
+            addRow(itr.first, itr.second->averageStrategy(), itr.second->actionNum());
+            delete itr.second;
+        }
+    }
+
+    // @brief Builds the table from strategy nodes.
+    // @param nodes The nodes indexed by information set; their average strategies are computed if needed.
+    StrategyTable::StrategyTable(const std::unordered_map<std::string, Trainer::Node *> &nodes)
+    {
+        mIndex.reserve(nodes.size());
+        for (const auto &itr : nodes)
+        {
+            addRow(itr.first, itr.second->averageStrategy(), itr.second->actionNum());
+        }
+    }
+
+    // @brief Returns the row of an information set.
+    // @param infoSetStr The information set key.
+    // @return The row index. Throws std::out_of_range if the information set is not in the table.
+    int StrategyTable::at(const std::string &infoSetStr) const
+    {
+        return mIndex.at(infoSetStr);
+    }
+
+    // @brief Returns the row of an information set, if present.
+    // @param infoSetStr The information set key.
+    // @return The row index, or -1 if the information set is not in the table.
+    int StrategyTable::find(const std::string &infoSetStr) const
+    {
+        auto itr = mIndex.find(infoSetStr);
+        return itr != mIndex.end() ? itr->second : -1;
+    }
+
+    // @brief Returns the number of rows.
+    // @return The number of information sets.
+    size_t StrategyTable::size() const
+    {
+        return mOffset.size();
+    }
+
+    // @brief Returns the number of actions of a row.
+    // @param row The row index.
+    // @return The number of actions.
+    int StrategyTable::actionNum(const int row) const
+    {
+        return mActionNum[row];
+    }
+
+    // @brief Returns the average strategy of a row.
+    // @param row The row index.
+    // @return A pointer to the action probabilities.
+    const double *StrategyTable::probability(const int row) const
+    {
+        return mProbability.data() + mOffset[row];
+    }
+
+    // @brief Samples an action of a row.
+    // @param row The row index.
+    // @param uniform A uniform random number in [0, 1).
+    // @return The sampled action.
+    int StrategyTable::sample(const int row, const double uniform) const
+    {
+        // the integer part of the scaled number picks a column, the fractional part decides between it and its alias
+        const uint64_t offset = mOffset[row];
+        const double scaled = uniform * double(mActionNum[row]);
+        int column = int(scaled);
+        if (column >= mActionNum[row])
+        {
+            column = mActionNum[row] - 1;
+        }
+        return scaled - double(column) < mAliasThreshold[offset + column] ? column : mAlias[offset + column];
+    }
+
+    // @brief Returns the memory held by the table.
+    // @return The number of bytes.
+    uint64_t StrategyTable::memoryBytes() const
+    {
+        uint64_t bytes = Trainer::HashTableBytes(mIndex);
+        for (const auto &itr : mIndex)
+        {
+            bytes += Trainer::KeyBytes(itr.first);
+        }
+        bytes += mOffset.capacity() * sizeof(uint64_t) + mActionNum.capacity() + mAlias.capacity();
+        bytes += (mProbability.capacity() + mAliasThreshold.capacity()) * sizeof(double);
+        return bytes;
+    }
+
+    // @brief Appends a row and builds its alias table.
+    // @param infoSetStr The information set key.
+    // @param probability The action probabilities.
+    // @param actionNum The number of actions.
+    void StrategyTable::addRow(const std::string &infoSetStr, const double *probability, const int actionNum)
+    {
+        const uint64_t offset = mProbability.size();
+        mIndex.emplace(infoSetStr, int(mOffset.size()));
+        mOffset.push_back(offset);
+        mActionNum.push_back(uint8_t(actionNum));
+        mProbability.insert(mProbability.end(), probability, probability + actionNum);
+        mAliasThreshold.resize(offset + actionNum, 1.0);
+        mAlias.resize(offset + actionNum, 0);
+
+        // Vose's method: columns below the mean are topped up by one column above it
+        double total = 0.0;
+        for (int a = 0; a < actionNum; ++a)
+        {
+            total += probability[a];
+        }
+        double scaled[actionNum];
+        int small[actionNum], large[actionNum];
+        int smallNum = 0, largeNum = 0, mostLikely = 0;
+        for (int a = 0; a < actionNum; ++a)
+        {
+            scaled[a] = total > 0.0 ? probability[a] * double(actionNum) / total : 1.0;
+            mAlias[offset + a] = uint8_t(a);
+            if (scaled[a] < 1.0)
+            {
+                small[smallNum++] = a;
+            }
+            else
+            {
+                large[largeNum++] = a;
+            }
+            if (probability[a] > probability[mostLikely])
+            {
+                mostLikely = a;
+            }
+        }
+        while (smallNum > 0 && largeNum > 0)
+        {
+            const int less = small[--smallNum], more = large[largeNum - 1];
+            mAliasThreshold[offset + less] = scaled[less];
+            mAlias[offset + less] = uint8_t(more);
+            scaled[more] -= 1.0 - scaled[less];
+            if (scaled[more] < 1.0)
+            {
+                --largeNum;
+                small[smallNum++] = more;
+            }
+        }
+
+        // columns left over by rounding keep themselves, unless they must never be sampled
+        while (smallNum > 0)
+        {
+            const int less = small[--smallNum];
+            mAliasThreshold[offset + less] = probability[less] > 0.0 ? 1.0 : 0.0;
+            mAlias[offset + less] = uint8_t(mostLikely);
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef GRASP_STRATEGYTABLE_HPP
+#define GRASP_STRATEGYTABLE_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Node.hpp"
+
+namespace Agent
+{
+    // @brief Average strategies of a strategy file, laid out for fast lookup and sampling.
+    // @details Every information set becomes a row. The probabilities of all rows are stored contiguously, together with
+    //          an alias table per row (Vose's method), so that sampling an action takes one uniform number and one
+    //          table lookup regardless of the number of actions.
+    class StrategyTable
+    {
+    public:
+        // @brief Loads a strategy file written by Trainer::writeStrategyToBin.
+        // @param path The path of the strategy file.
+        explicit StrategyTable(const std::string &path);
+
+        // @brief Builds the table from strategy nodes.
+        // @param nodes The nodes indexed by information set; their average strategies are computed if needed.
+        explicit StrategyTable(const std::unordered_map<std::string, Trainer::Node *> &nodes);
+
+        // @brief Returns the row of an information set.
+        // @param infoSetStr The information set key.
+        // @return The row index. Throws std::out_of_range if the information set is not in the table.
+        int at(const std::string &infoSetStr) const;
+
+        // @brief Returns the row of an information set, if present.
+        // @param infoSetStr The information set key.
+        // @return The row index, or -1 if the information set is not in the table.
+        int find(const std::string &infoSetStr) const;
+
+        // @brief Returns the number of rows.
+        // @return The number of information sets.
+        size_t size() const;
+
+        // @brief Returns the number of actions of a row.
+        // @param row The row index.
+        // @return The number of actions.
+        int actionNum(int row) const;
+
+        // @brief Returns the average strategy of a row.
+        // @param row The row index.
+        // @return A pointer to the action probabilities.
+        const double *probability(int row) const;
+
+        // @brief Samples an action of a row.
+        // @param row The row index.
+        // @param uniform A uniform random number in [0, 1).
+        // @return The sampled action.
+        int sample(int row, double uniform) const;
+
+        // @brief Returns the memory held by the table.
+        // @return The number of bytes.
+        uint64_t memoryBytes() const;
+
+    private:
+        // @brief Appends a row and builds its alias table.
+        // @param infoSetStr The information set key.
+        // @param probability The action probabilities.
+        // @param actionNum The number of actions.
+        void addRow(const std::string &infoSetStr, const double *probability, int actionNum);
+
+        std::unordered_map<std::string, int> mIndex; // Row of every information set key.
+        std::vector<uint64_t> mOffset;               // Offset of every row in the per-action arrays.
+        std::vector<uint8_t> mActionNum;             // Number of actions of every row.
+        std::vector<double> mProbability;            // Action probabilities of every row.
+        std::vector<double> mAliasThreshold;         // Probability of keeping the drawn column instead of its alias.
+        std::vector<uint8_t> mAlias;                 // Alias action of every column.
+    };
+}
+
+#endif
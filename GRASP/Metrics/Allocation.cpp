@@ -0,0 +1,78 @@
+#include "Allocation.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// The replacement operators below are only linked into executables that reference Metrics::allocationStats(),
+// so binaries that do not ask for allocation accounting keep the default allocator untouched.
+
+namespace
+{
+    std::atomic<uint64_t> allocationCount(0); // Number of calls to operator new.
+    std::atomic<uint64_t> allocationBytes(0); // Number of bytes requested from operator new.
+
+    // @brief Records an allocation and forwards it to malloc.
+    // @param size The number of bytes requested.
+    // @return A pointer to the allocated memory, or nullptr on failure.
+    void *countedAlloc(const std::size_t size)
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocationBytes.fetch_add(size, std::memory_order_relaxed);
+        return std::malloc(size == 0 ? 1 : size);
+    }
+}
+
+namespace Metrics
+{
+    // @brief Returns the heap allocation counters of this process.
+    // @return The number of allocations and bytes requested so far.
+    AllocationStats allocationStats()
+    {
+        return AllocationStats{allocationCount.load(std::memory_order_relaxed), allocationBytes.load(std::memory_order_relaxed)};
+    }
+}
+
+void *operator new(const std::size_t size)
+{
+    void *ptr = countedAlloc(size);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](const std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(const std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void *operator new[](const std::size_t size, const std::nothrow_t &) noexcept
+{
+    return countedAlloc(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
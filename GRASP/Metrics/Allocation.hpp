@@ -0,0 +1,20 @@
+#ifndef GRASP_ALLOCATION_HPP
+#define GRASP_ALLOCATION_HPP
+
+#include <cstdint>
+
+namespace Metrics
+{
+    // @brief Snapshot of the heap allocation counters maintained by the operator new hook.
+    struct AllocationStats
+    {
+        uint64_t count; // Number of calls to operator new since the process started.
+        uint64_t bytes; // Number of bytes requested from operator new since the process started.
+    };
+
+    // @brief Returns the heap allocation counters of this process.
+    // @return The number of allocations and bytes requested so far.
+    AllocationStats allocationStats();
+}
+
+#endif
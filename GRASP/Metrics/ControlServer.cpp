@@ -0,0 +1,207 @@
+#include "ControlServer.hpp"
+#include <cmath>
+#include <sstream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Socket.hpp"
+
+namespace Metrics
+{
+    // Largest request accepted; the endpoint only expects a request line and a few headers.
+    static const size_t maxRequestBytes = 8192;
+
+    // Interval at which the server thread checks whether it should exit.
+    static const int pollMilliseconds = 200;
+
+    // @brief Escapes a string for use inside a JSON string literal.
+    // @param str The string to escape.
+    // @return The escaped string.
+    static std::string escapeJson(const std::string &str)
+    {
+        std::string escaped;
+        for (char c : str)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+            }
+            if ((unsigned char)c >= 0x20)
+            {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    // @brief Writes a complete HTTP response to a connection.
+    // @param fd The connected socket.
+    // @param code The status code.
+    // @param reason The reason phrase.
+    // @param body The JSON body.
+    static void respond(const int fd, const int code, const char *reason, const std::string &body)
+    {
+        std::ostringstream os;
+        os << "HTTP/1.0 " << code << " " << reason << "\r\nContent-Type: application/json\r\nContent-Length: " << body.size()
+           << "\r\nConnection: close\r\n\r\n"
+           << body;
+        const std::string response = os.str();
+        size_t written = 0;
+        while (written < response.size())
+        {
+            const ssize_t n = ::send(fd, response.data() + written, response.size() - written, MSG_NOSIGNAL);
+            if (n <= 0)
+            {
+                return;
+            }
+            written += size_t(n);
+        }
+    }
+
+    // @brief Constructs a server listening on the given address and starts its thread.
+    // @param address The path of a Unix domain socket, or a TCP port number bound on 127.0.0.1.
+    ControlServer::ControlServer(const std::string &address)
+        : mListenFd(-1), mStatus(), mCheckpointRequested(false), mStopRequested(false), mStop(false)
+    {
+        mStatus.state = "training";
+        mListenFd = listenOn(address, 16, mSocketPath);
+        mThread = std::thread(&ControlServer::run, this);
+    }
+
+    // @brief Destructor for ControlServer, stopping the thread and removing the Unix socket.
+    ControlServer::~ControlServer()
+    {
+        mStop = true;
+        mThread.join();
+        ::close(mListenFd);
+        removeSocket(mSocketPath);
+    }
+
+    // @brief Replaces the served status.
+    // @param status The new status; its nodesPerSecond is derived from the previous snapshot.
+    void ControlServer::publish(const TrainingStatus &status)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        const double seconds = status.wallSeconds - mStatus.wallSeconds;
+        const double nodesPerSecond = seconds > 0.0 ? double(status.nodesTouched - mStatus.nodesTouched) / seconds : mStatus.nodesPerSecond;
+        mStatus = status;
+        mStatus.nodesPerSecond = nodesPerSecond;
+    }
+
+    // @brief Returns whether a checkpoint has been requested since the last call, and clears the request.
+    // @return True if POST /checkpoint has been received since the last call.
+    bool ControlServer::consumeCheckpointRequest()
+    {
+        return mCheckpointRequested.load(std::memory_order_relaxed) && mCheckpointRequested.exchange(false);
+    }
+
+    // @brief Returns whether a graceful stop has been requested.
+    // @return True if POST /stop has been received.
+    bool ControlServer::stopRequested() const
+    {
+        return mStopRequested.load(std::memory_order_relaxed);
+    }
+
+    // @brief Body of the server thread.
+    void ControlServer::run()
+    {
+        pollfd pfd;
+        pfd.fd = mListenFd;
+        pfd.events = POLLIN;
+        while (!mStop)
+        {
+            if (::poll(&pfd, 1, pollMilliseconds) <= 0 || (pfd.revents & POLLIN) == 0)
+            {
+                continue;
+            }
+            const int fd = ::accept(mListenFd, nullptr, nullptr);
+            if (fd < 0)
+            {
+                continue;
+            }
+            serve(fd);
+            ::close(fd);
+        }
+    }
+
+    // @brief Reads one request from a connection and writes the response.
+    // @param fd The connected socket.
+    void ControlServer::serve(const int fd)
+    {
+        // a stalled client must not keep the endpoint busy
+        timeval timeout;
+        timeout.tv_sec = 1;
+        timeout.tv_usec = 0;
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        std::string request;
+        char buffer[1024];
+        while (request.find("\r\n\r\n") == std::string::npos && request.find("\n\n") == std::string::npos)
+        {
+            const ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0)
+            {
+                break;
+            }
+            request.append(buffer, size_t(n));
+            if (request.size() > maxRequestBytes)
+            {
+                respond(fd, 413, "Payload Too Large", "{\"error\":\"request too large\"}");
+                return;
+            }
+        }
+
+        std::istringstream is(request);
+        std::string method, target;
+        is >> method >> target;
+        if (target == "/status")
+        {
+            if (method != "GET")
+            {
+                respond(fd, 405, "Method Not Allowed", "{\"error\":\"use GET\"}");
+                return;
+            }
+            respond(fd, 200, "OK", statusJson());
+        }
+        else if (target == "/checkpoint" || target == "/stop")
+        {
+            if (method != "POST")
+            {
+                respond(fd, 405, "Method Not Allowed", "{\"error\":\"use POST\"}");
+                return;
+            }
+            (target == "/checkpoint" ? mCheckpointRequested : mStopRequested) = true;
+            respond(fd, 202, "Accepted", "{\"accepted\":\"" + target.substr(1) + "\"}");
+        }
+        else
+        {
+            respond(fd, 404, "Not Found", "{\"error\":\"unknown endpoint\"}");
+        }
+    }
+
+    // @brief Formats the current status as a JSON object.
+    // @return The JSON text.
+    std::string ControlServer::statusJson()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::ostringstream os;
+        os << "{\"state\":\"" << escapeJson(mStatus.state) << "\",\"iteration\":" << mStatus.iteration
+           << ",\"target_iterations\":" << mStatus.targetIterations << ",\"wall_seconds\":" << mStatus.wallSeconds
+           << ",\"nodes_touched\":" << mStatus.nodesTouched << ",\"nodes_per_second\":" << mStatus.nodesPerSecond
+           << ",\"infosets\":" << mStatus.infoSetNum << ",\"memory_bytes\":" << mStatus.memoryBytes
+           << ",\"regret_bound\":" << mStatus.regretBound << ",\"exploitability\":";
+        if (mStatus.hasExploitability && std::isfinite(mStatus.exploitability))
+        {
+            os << mStatus.exploitability << ",\"exploitability_iteration\":" << mStatus.exploitabilityIteration;
+        }
+        else
+        {
+            os << "null,\"exploitability_iteration\":null";
+        }
+        os << ",\"checkpoints\":" << mStatus.checkpointCount << ",\"last_checkpoint_iteration\":" << mStatus.lastCheckpointIteration
+           << ",\"last_checkpoint_path\":\"" << escapeJson(mStatus.lastCheckpointPath)
+           << "\",\"checkpoint_pending\":" << (mCheckpointRequested ? "true" : "false")
+           << ",\"stop_requested\":" << (mStopRequested ? "true" : "false") << "}\n";
+        return os.str();
+    }
+}
@@ -0,0 +1,85 @@
+#ifndef GRASP_CONTROLSERVER_HPP
+#define GRASP_CONTROLSERVER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Metrics
+{
+    // @brief A snapshot of a training run, published by the trainer and served by the control endpoint.
+    struct TrainingStatus
+    {
+        std::string state;                // "training", "checkpointing" or "finished".
+        uint64_t iteration;               // Number of iterations completed.
+        uint64_t targetIterations;        // Number of iterations requested.
+        double wallSeconds;               // Wall time since training started.
+        uint64_t nodesTouched;            // Cumulative number of nodes touched.
+        double nodesPerSecond;            // Nodes touched per second since the previous snapshot; set by the server.
+        uint64_t infoSetNum;              // Number of information sets in the node map.
+        uint64_t memoryBytes;             // Resident memory of the process.
+        double regretBound;               // Exploitability upper bound implied by the cumulative regrets.
+        bool hasExploitability;           // Flag indicating if the exploitability has been evaluated.
+        double exploitability;            // Exploitability of the last evaluation.
+        uint64_t exploitabilityIteration; // Number of iterations completed at the last evaluation.
+        uint64_t checkpointCount;         // Number of checkpoints written.
+        uint64_t lastCheckpointIteration; // Number of iterations completed at the last checkpoint.
+        std::string lastCheckpointPath;   // Path of the last checkpoint, or empty.
+    };
+
+    // @brief Serves the status of a training run and accepts control commands over a local HTTP endpoint.
+    // @details The endpoint is a Unix domain socket, or a loopback TCP port if the address is a number. A background
+    //          thread answers one request per connection:
+    //            GET  /status      the last published TrainingStatus as JSON
+    //            POST /checkpoint  asks the trainer to write a checkpoint at the next iteration
+    //            POST /stop        asks the trainer to stop after the current iteration and write its final strategy
+    //          The trainer publishes snapshots and polls the requests; the server never touches training state.
+    class ControlServer
+    {
+    public:
+        // @brief Constructs a server listening on the given address and starts its thread.
+        // @param address The path of a Unix domain socket, or a TCP port number bound on 127.0.0.1.
+        // @throws std::runtime_error If the port is out of range or the address cannot be bound.
+        explicit ControlServer(const std::string &address);
+
+        // @brief Destructor for ControlServer, stopping the thread and removing the Unix socket.
+        ~ControlServer();
+
+        // @brief Replaces the served status.
+        // @param status The new status; its nodesPerSecond is derived from the previous snapshot.
+        void publish(const TrainingStatus &status);
+
+        // @brief Returns whether a checkpoint has been requested since the last call, and clears the request.
+        // @return True if POST /checkpoint has been received since the last call.
+        bool consumeCheckpointRequest();
+
+        // @brief Returns whether a graceful stop has been requested.
+        // @return True if POST /stop has been received.
+        bool stopRequested() const;
+
+    private:
+        // @brief Body of the server thread.
+        void run();
+
+        // @brief Reads one request from a connection and writes the response.
+        // @param fd The connected socket.
+        void serve(int fd);
+
+        // @brief Formats the current status as a JSON object.
+        // @return The JSON text.
+        std::string statusJson();
+
+        std::string mSocketPath;                // Path of the Unix socket, or empty when listening on TCP.
+        int mListenFd;                          // Listening socket.
+        std::mutex mMutex;                      // Mutex guarding the status.
+        TrainingStatus mStatus;                 // Last published status.
+        std::atomic<bool> mCheckpointRequested; // Flag set by POST /checkpoint.
+        std::atomic<bool> mStopRequested;       // Flag set by POST /stop.
+        std::atomic<bool> mStop;                // Flag asking the server thread to exit.
+        std::thread mThread;                    // Server thread.
+    };
+}
+
+#endif
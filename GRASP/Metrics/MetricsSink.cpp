@@ -0,0 +1,180 @@
+#include "MetricsSink.hpp"
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace Metrics
+{
+    // Upper bound of the pending buffer; records arriving while it is full are dropped.
+    static const size_t maxPendingBytes = 1 << 22;
+
+    // @brief Constructs a sink writing to a file, or to standard output if the path is empty.
+    // @param format The output format.
+    // @param path The path of the output file.
+    MetricsSink::MetricsSink(const Format format, const std::string &path)
+        : mFormat(format), mOut(&std::cout), mHeaderWritten(false), mWriting(false), mStop(false), mDropped(0)
+    {
+        if (!path.empty())
+        {
+            mFile.open(path);
+            if (!mFile)
+            {
+                throw std::runtime_error("cannot open metrics file \"" + path + "\"");
+            }
+            mOut = &mFile;
+        }
+        mWriter = std::thread(&MetricsSink::run, this);
+    }
+
+    // @brief Destructor for MetricsSink, flushing every pending record before the writer thread stops.
+    MetricsSink::~MetricsSink()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+        mCondition.notify_all();
+        mWriter.join();
+    }
+
+    // @brief Parses a format name ("jsonl" or "csv").
+    // @param name The format name.
+    // @return The corresponding format.
+    MetricsSink::Format MetricsSink::ParseFormat(const std::string &name)
+    {
+        if (name == "jsonl")
+        {
+            return Format::JSONL;
+        }
+        if (name == "csv")
+        {
+            return Format::CSV;
+        }
+        throw std::invalid_argument("unknown metrics format \"" + name + "\"");
+    }
+
+    // @brief Queues a record for writing.
+    // @param record The record to write.
+    void MetricsSink::write(const Record &record)
+    {
+        std::string line = format(record);
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mPending.size() + line.size() > maxPendingBytes)
+            {
+                ++mDropped;
+                return;
+            }
+            mPending += line;
+        }
+        mCondition.notify_all();
+    }
+
+    // @brief Blocks until every queued record has been written.
+    void MetricsSink::flush()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mCondition.wait(lock, [this]()
+                        { return mPending.empty() && !mWriting; });
+    }
+
+    // @brief Returns the number of records dropped because the writer fell behind.
+    // @return The number of dropped records.
+    uint64_t MetricsSink::droppedCount() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mDropped;
+    }
+
+    // @brief Formats a record in the configured format.
+    // @param record The record to format.
+    // @return The formatted line, including the CSV header before the first record.
+    std::string MetricsSink::format(const Record &record)
+    {
+        std::ostringstream os;
+        os.precision(10);
+        if (mFormat == Format::JSONL)
+        {
+            os << "{\"iteration\":" << record.iteration << ",\"wall_seconds\":" << record.wallSeconds
+               << ",\"nodes_touched\":" << record.nodesTouched << ",\"nodes_per_second\":" << record.nodesPerSecond
+               << ",\"infosets\":" << record.infoSetNum << ",\"memory_bytes\":" << record.memoryBytes << ",\"utils\":[";
+            for (size_t p = 0; p < record.utils.size(); ++p)
+            {
+                os << (p == 0 ? "" : ",") << record.utils[p];
+            }
+            os << "]";
+            for (const auto &value : record.extra)
+            {
+                os << ",\"" << value.first << "\":" << value.second;
+            }
+            os << "}\n";
+            return os.str();
+        }
+
+        if (!mHeaderWritten)
+        {
+            os << "iteration,wall_seconds,nodes_touched,nodes_per_second,infosets,memory_bytes";
+            for (size_t p = 0; p < record.utils.size(); ++p)
+            {
+                os << ",util_" << p;
+            }
+            for (const auto &value : record.extra)
+            {
+                os << "," << value.first;
+            }
+            os << "\n";
+            mHeaderWritten = true;
+        }
+        os << record.iteration << "," << record.wallSeconds << "," << record.nodesTouched << "," << record.nodesPerSecond
+           << "," << record.infoSetNum << "," << record.memoryBytes;
+        for (double util : record.utils)
+        {
+            os << "," << util;
+        }
+        for (const auto &value : record.extra)
+        {
+            os << "," << value.second;
+        }
+        os << "\n";
+        return os.str();
+    }
+
+    // @brief Body of the writer thread.
+    void MetricsSink::run()
+    {
+        std::string buffer;
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (true)
+        {
+            mCondition.wait(lock, [this]()
+                            { return mStop || !mPending.empty(); });
+            if (mPending.empty() && mStop)
+            {
+                break;
+            }
+            buffer.swap(mPending);
+            mWriting = true;
+            lock.unlock();
+            mOut->write(buffer.data(), std::streamsize(buffer.size()));
+            mOut->flush();
+            buffer.clear();
+            lock.lock();
+            mWriting = false;
+            mCondition.notify_all();
+        }
+    }
+
+    // @brief Returns the resident memory of the current process.
+    // @return The resident set size in bytes, or 0 if it cannot be determined.
+    uint64_t residentMemoryBytes()
+    {
+        std::ifstream statm("/proc/self/statm");
+        uint64_t size = 0, resident = 0;
+        if (!(statm >> size >> resident))
+        {
+            return 0;
+        }
+        return resident * uint64_t(sysconf(_SC_PAGESIZE));
+    }
+}
@@ -0,0 +1,94 @@
+#ifndef GRASP_METRICSSINK_HPP
+#define GRASP_METRICSSINK_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Metrics
+{
+    // @brief A progress sample of a training run.
+    struct Record
+    {
+        uint64_t iteration;        // Index of the iteration that has just completed.
+        double wallSeconds;        // Wall time since training started.
+        uint64_t nodesTouched;     // Cumulative number of nodes touched.
+        double nodesPerSecond;     // Nodes touched per second since the previous record.
+        uint64_t infoSetNum;       // Number of information sets in the node map.
+        uint64_t memoryBytes;      // Resident memory of the process.
+        std::vector<double> utils; // Utility of each player in the last iteration.
+        // Additional named values, e.g. hardware counters. The set of names must stay the same during a CSV run.
+        std::vector<std::pair<std::string, double>> extra;
+    };
+
+    // @brief Writes training records as JSON lines or CSV through a background writer thread.
+    // @details Records are formatted into an in-memory buffer and handed to the writer thread, so the training loop
+    //          never waits on the terminal or the file system. If the writer falls too far behind, records are dropped
+    //          and counted instead of blocking the caller.
+    class MetricsSink
+    {
+    public:
+        // @brief Output formats supported by the sink.
+        enum class Format
+        {
+            JSONL, // One JSON object per line.
+            CSV,   // Comma-separated values with a header line.
+        };
+
+        // @brief Constructs a sink writing to a file, or to standard output if the path is empty.
+        // @param format The output format.
+        // @param path The path of the output file.
+        explicit MetricsSink(Format format, const std::string &path = "");
+
+        // @brief Destructor for MetricsSink, flushing every pending record before the writer thread stops.
+        ~MetricsSink();
+
+        // @brief Parses a format name ("jsonl" or "csv").
+        // @param name The format name.
+        // @return The corresponding format.
+        static Format ParseFormat(const std::string &name);
+
+        // @brief Queues a record for writing.
+        // @param record The record to write.
+        void write(const Record &record);
+
+        // @brief Blocks until every queued record has been written.
+        void flush();
+
+        // @brief Returns the number of records dropped because the writer fell behind.
+        // @return The number of dropped records.
+        uint64_t droppedCount() const;
+
+    private:
+        // @brief Formats a record in the configured format.
+        // @param record The record to format.
+        // @return The formatted line, including the CSV header before the first record.
+        std::string format(const Record &record);
+
+        // @brief Body of the writer thread.
+        void run();
+
+        Format mFormat;                     // Output format.
+        std::ofstream mFile;                // Output file, unused when writing to standard output.
+        std::ostream *mOut;                 // Stream the writer thread writes to.
+        bool mHeaderWritten;                // Flag indicating if the CSV header has been emitted.
+        mutable std::mutex mMutex;          // Mutex guarding the pending buffer and flags below.
+        std::condition_variable mCondition; // Condition signalled when data is queued or written.
+        std::string mPending;               // Formatted records not yet handed to the writer.
+        bool mWriting;                      // Flag indicating if the writer thread is writing a buffer.
+        bool mStop;                         // Flag asking the writer thread to exit.
+        uint64_t mDropped;                  // Number of records dropped because the buffer was full.
+        std::thread mWriter;                // Background writer thread.
+    };
+
+    // @brief Returns the resident memory of the current process.
+    // @return The resident set size in bytes, or 0 if it cannot be determined.
+    uint64_t residentMemoryBytes();
+}
+
+#endif
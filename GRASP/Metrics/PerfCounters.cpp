@@ -0,0 +1,161 @@
+#include "PerfCounters.hpp"
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Metrics
+{
+    // @brief Returns the snake_case name of a counter, used as a metrics field name.
+    // @param counter The counter.
+    // @return The name of the counter.
+    const char *CounterName(const Counter counter)
+    {
+        switch (counter)
+        {
+        case Counter::CYCLES:
+            return "cycles";
+        case Counter::INSTRUCTIONS:
+            return "instructions";
+        case Counter::L1D_MISSES:
+            return "l1d_misses";
+        case Counter::LLC_MISSES:
+            return "llc_misses";
+        case Counter::BRANCH_MISSES:
+            return "branch_misses";
+        default:
+            return "unknown";
+        }
+    }
+
+#ifdef __linux__
+    // @brief Opens a single user-space counter of the calling thread.
+    // @param type The perf event type.
+    // @param config The perf event configuration.
+    // @return The file descriptor of the counter, or -1 on failure.
+    static int openCounter(const uint32_t type, const uint64_t config)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    // @brief Opens the counters for the calling thread, stopped and zeroed.
+    PerfCounters::PerfCounters()
+    {
+        const uint64_t l1dReadMiss = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        mFd[(int)Counter::CYCLES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        mFd[(int)Counter::INSTRUCTIONS] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        mFd[(int)Counter::L1D_MISSES] = openCounter(PERF_TYPE_HW_CACHE, l1dReadMiss);
+        mFd[(int)Counter::LLC_MISSES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        mFd[(int)Counter::BRANCH_MISSES] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        for (int fd : mFd)
+        {
+            if (fd >= 0)
+            {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            }
+        }
+    }
+
+    // @brief Destructor for PerfCounters, closing every counter.
+    PerfCounters::~PerfCounters()
+    {
+        for (int fd : mFd)
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+    }
+
+    // @brief Resumes counting.
+    void PerfCounters::start()
+    {
+        for (int fd : mFd)
+        {
+            if (fd >= 0)
+            {
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    }
+
+    // @brief Pauses counting; the accumulated values are kept.
+    void PerfCounters::stop()
+    {
+        for (int fd : mFd)
+        {
+            if (fd >= 0)
+            {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+    }
+
+    // @brief Reads the values accumulated while counting was running.
+    // @return The counter values.
+    CounterValues PerfCounters::read() const
+    {
+        CounterValues values;
+        for (int i = 0; i < (int)Counter::NUM; ++i)
+        {
+            // value, time enabled, time running; scale up when the kernel multiplexed the counter
+            uint64_t data[3] = {0, 0, 0};
+            values.valid[i] = mFd[i] >= 0 && ::read(mFd[i], data, sizeof(data)) == sizeof(data);
+            values.value[i] = values.valid[i] && data[2] > 0 && data[2] < data[1] ? uint64_t(double(data[0]) * double(data[1]) / double(data[2])) : data[0];
+        }
+        return values;
+    }
+#else
+    PerfCounters::PerfCounters()
+    {
+        for (int &fd : mFd)
+        {
+            fd = -1;
+        }
+    }
+
+    PerfCounters::~PerfCounters() {}
+
+    void PerfCounters::start() {}
+
+    void PerfCounters::stop() {}
+
+    CounterValues PerfCounters::read() const
+    {
+        CounterValues values;
+        for (int i = 0; i < (int)Counter::NUM; ++i)
+        {
+            values.value[i] = 0;
+            values.valid[i] = false;
+        }
+        return values;
+    }
+#endif
+
+    // @brief Returns whether at least one counter could be opened.
+    // @return True if some counter is available.
+    bool PerfCounters::available() const
+    {
+        for (int fd : mFd)
+        {
+            if (fd >= 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef GRASP_PERFCOUNTERS_HPP
+#define GRASP_PERFCOUNTERS_HPP
+
+#include <cstdint>
+
+namespace Metrics
+{
+    // @enum Counter
+    // @brief Hardware events counted by PerfCounters.
+    enum class Counter : int
+    {
+        CYCLES = 0,    // CPU cycles.
+        INSTRUCTIONS,  // Retired instructions.
+        L1D_MISSES,    // L1 data cache read misses.
+        LLC_MISSES,    // Last-level cache misses.
+        BRANCH_MISSES, // Mispredicted branches.
+        NUM            // The total number of counters.
+    };
+
+    // @brief Returns the snake_case name of a counter, used as a metrics field name.
+    // @param counter The counter.
+    // @return The name of the counter.
+    const char *CounterName(Counter counter);
+
+    // @brief Values of every counter; counters that could not be opened are marked invalid.
+    struct CounterValues
+    {
+        uint64_t value[(int)Counter::NUM]; // Counted events, scaled for multiplexing.
+        bool valid[(int)Counter::NUM];     // Flag indicating if the counter is available.
+    };
+
+    // @brief Counts hardware events of the calling thread through perf_event_open.
+    // @details Counters the kernel or the CPU refuses (e.g. under a strict perf_event_paranoid setting or in a VM without
+    //          a PMU) are skipped; on platforms other than Linux no counter is available.
+    class PerfCounters
+    {
+    public:
+        // @brief Opens the counters for the calling thread, stopped and zeroed.
+        PerfCounters();
+
+        // @brief Destructor for PerfCounters, closing every counter.
+        ~PerfCounters();
+
+        PerfCounters(const PerfCounters &) = delete;
+        PerfCounters &operator=(const PerfCounters &) = delete;
+
+        // @brief Returns whether at least one counter could be opened.
+        // @return True if some counter is available.
+        bool available() const;
+
+        // @brief Resumes counting.
+        void start();
+
+        // @brief Pauses counting; the accumulated values are kept.
+        void stop();
+
+        // @brief Reads the values accumulated while counting was running.
+        // @return The counter values.
+        CounterValues read() const;
+
+    private:
+        int mFd[(int)Counter::NUM]; // File descriptor of each counter, or -1 if unavailable.
+    };
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include "PhaseTimer.hpp"
+#include <iomanip>
+
+namespace Metrics
+{
+    // @brief Returns the display name of a phase.
+    // @param phase The phase.
+    // @return The name of the phase.
+    const char *PhaseName(const Phase phase)
+    {
+        switch (phase)
+        {
+        case Phase::TRAVERSAL:
+            return "traversal";
+        case Phase::STRATEGY_UPDATE:
+            return "strategy update";
+        case Phase::NODE_CREATION:
+            return "node creation";
+        case Phase::LOGGING:
+            return "logging";
+        case Phase::CHECKPOINT:
+            return "checkpoint";
+        default:
+            return "unknown";
+        }
+    }
+
+    // @brief Constructs an empty profile.
+    PhaseProfile::PhaseProfile()
+    {
+        for (int i = 0; i < (int)Phase::NUM; ++i)
+        {
+            mNanoseconds[i] = 0;
+            mCount[i] = 0;
+        }
+    }
+
+    // @brief Adds a measured interval to a phase.
+    // @param phase The phase.
+    // @param nanoseconds The length of the interval in nanoseconds.
+    void PhaseProfile::add(const Phase phase, const uint64_t nanoseconds)
+    {
+        mNanoseconds[(int)phase] += nanoseconds;
+        mCount[(int)phase] += 1;
+    }
+
+    // @brief Returns the accumulated wall time of a phase.
+    // @param phase The phase.
+    // @return The wall time in seconds.
+    double PhaseProfile::seconds(const Phase phase) const
+    {
+        return double(mNanoseconds[(int)phase]) * 1e-9;
+    }
+
+    // @brief Writes a summary table of every phase.
+    // @param os The output stream.
+    // @param totalSeconds The wall time of the whole run, used to print the share of each phase.
+    void PhaseProfile::write(std::ostream &os, const double totalSeconds) const
+    {
+        const std::ios::fmtflags flags = os.flags();
+        const std::streamsize precision = os.precision();
+        os << "phase timing (total " << totalSeconds << " s, node creation is included in traversal):" << std::endl;
+        for (int i = 0; i < (int)Phase::NUM; ++i)
+        {
+            const double sec = seconds(Phase(i));
+            os << "  " << std::left << std::setw(16) << PhaseName(Phase(i)) << std::right << std::fixed
+               << std::setprecision(6) << std::setw(14) << sec << " s"
+               << std::setprecision(1) << std::setw(8) << (totalSeconds > 0 ? 100.0 * sec / totalSeconds : 0.0) << " %"
+               << std::setw(14) << mCount[i] << " calls" << std::endl;
+        }
+        os.flags(flags);
+        os.precision(precision);
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef GRASP_PHASETIMER_HPP
+#define GRASP_PHASETIMER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace Metrics
+{
+    // @enum Phase
+    // @brief Phases of a training run whose wall time is accounted separately.
+    enum class Phase : int
+    {
+        TRAVERSAL = 0,   // Recursive CFR traversals of the game tree.
+        STRATEGY_UPDATE, // Sweeps calling updateStrategy on every node.
+        NODE_CREATION,   // Allocation and insertion of new nodes, nested inside traversals.
+        LOGGING,         // Formatting and queueing progress records.
+        CHECKPOINT,      // Serializing strategies to disk.
+        NUM              // The total number of phases.
+    };
+
+    // @brief Returns the display name of a phase.
+    // @param phase The phase.
+    // @return The name of the phase.
+    const char *PhaseName(Phase phase);
+
+    // @brief Accumulates wall time and call counts per training phase.
+    class PhaseProfile
+    {
+    public:
+        // @brief Constructs an empty profile.
+        PhaseProfile();
+
+        // @brief Adds a measured interval to a phase.
+        // @param phase The phase.
+        // @param nanoseconds The length of the interval in nanoseconds.
+        void add(Phase phase, uint64_t nanoseconds);
+
+        // @brief Returns the accumulated wall time of a phase.
+        // @param phase The phase.
+        // @return The wall time in seconds.
+        double seconds(Phase phase) const;
+
+        // @brief Writes a summary table of every phase.
+        // @param os The output stream.
+        // @param totalSeconds The wall time of the whole run, used to print the share of each phase.
+        void write(std::ostream &os, double totalSeconds) const;
+
+    private:
+        uint64_t mNanoseconds[(int)Phase::NUM]; // Accumulated wall time of each phase.
+        uint64_t mCount[(int)Phase::NUM];       // Number of measured intervals of each phase.
+    };
+
+    // @brief Adds the lifetime of the object to a phase of a profile.
+    class ScopedPhase
+    {
+    public:
+        // @brief Starts measuring a phase.
+        // @param profile The profile to add the measured interval to.
+        // @param phase The phase being measured.
+        ScopedPhase(PhaseProfile &profile, Phase phase)
+            : mProfile(profile), mPhase(phase), mStart(std::chrono::steady_clock::now())
+        {
+        }
+
+        // @brief Stops measuring and records the interval.
+        ~ScopedPhase()
+        {
+            mProfile.add(mPhase, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mStart).count()));
+        }
+
+    private:
+        PhaseProfile &mProfile;                       // Profile receiving the interval.
+        Phase mPhase;                                 // Phase being measured.
+        std::chrono::steady_clock::time_point mStart; // Start of the interval.
+    };
+}
+
+// GRASP_PHASE_SCOPE(profile, phase) times the enclosing scope when the build defines GRASP_PHASE_TIMING and expands to
+// nothing otherwise, so that instrumented code costs nothing in regular builds.
+#define GRASP_PHASE_CONCAT_IMPL(a, b) a##b
+#define GRASP_PHASE_CONCAT(a, b) GRASP_PHASE_CONCAT_IMPL(a, b)
+#ifdef GRASP_PHASE_TIMING
+#define GRASP_PHASE_SCOPE(profile, phase) Metrics::ScopedPhase GRASP_PHASE_CONCAT(graspPhaseScope, __LINE__)(profile, phase)
+#else
+#define GRASP_PHASE_SCOPE(profile, phase)
+#endif
+
+#endif
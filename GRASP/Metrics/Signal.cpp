@@ -0,0 +1,33 @@
+#include "Signal.hpp"
+#include <csignal>
+
+namespace Metrics
+{
+    // Flag set by the signal handler and cleared by consumeReportRequest().
+    static volatile std::sig_atomic_t reportRequested = 0;
+
+    // @brief Signal handler recording a report request.
+    // @param signal The received signal.
+    static void onReportSignal(int)
+    {
+        reportRequested = 1;
+    }
+
+    // @brief Installs a handler that records a report request whenever the process receives SIGUSR1.
+    void installReportHandler()
+    {
+        std::signal(SIGUSR1, onReportSignal);
+    }
+
+    // @brief Returns whether a report has been requested since the last call, and clears the request.
+    // @return True if SIGUSR1 has been received since the last call.
+    bool consumeReportRequest()
+    {
+        if (reportRequested == 0)
+        {
+            return false;
+        }
+        reportRequested = 0;
+        return true;
+    }
+}
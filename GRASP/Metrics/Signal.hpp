@@ -0,0 +1,14 @@
+#ifndef GRASP_SIGNAL_HPP
+#define GRASP_SIGNAL_HPP
+
+namespace Metrics
+{
+    // @brief Installs a handler that records a report request whenever the process receives SIGUSR1.
+    void installReportHandler();
+
+    // @brief Returns whether a report has been requested since the last call, and clears the request.
+    // @return True if SIGUSR1 has been received since the last call.
+    bool consumeReportRequest();
+}
+
+#endif
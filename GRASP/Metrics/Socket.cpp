@@ -0,0 +1,126 @@
+#include "Socket.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace Metrics
+{
+    // @brief Returns whether a path names a Unix socket, without following symbolic links.
+    // @param path The path.
+    // @return True if the path exists and is a socket.
+    static bool isSocket(const std::string &path)
+    {
+        struct stat status;
+        return ::lstat(path.c_str(), &status) == 0 && S_ISSOCK(status.st_mode);
+    }
+
+    // @brief Parses a TCP port number.
+    // @param address A non-empty sequence of decimal digits.
+    // @return The port.
+    // @throws std::runtime_error If the port is not between 1 and 65535.
+    static uint16_t parsePort(const std::string &address)
+    {
+        unsigned long port = 0;
+        for (char c : address)
+        {
+            port = port * 10 + unsigned(c - '0');
+            if (port > 65535)
+            {
+                break;
+            }
+        }
+        if (port == 0 || port > 65535)
+        {
+            throw std::runtime_error("port " + address + " is not between 1 and 65535");
+        }
+        return uint16_t(port);
+    }
+
+    // @brief Opens a listening socket.
+    // @param address The path of a Unix domain socket, or a TCP port number bound on 127.0.0.1.
+    // @param backlog The length of the queue of pending connections.
+    // @param socketPath Receives the path of the Unix socket created, empty for TCP.
+    // @return The listening socket.
+    // @throws std::runtime_error If the port is out of range or the address cannot be bound.
+    int listenOn(const std::string &address, const int backlog, std::string &socketPath)
+    {
+        socketPath.clear();
+        int fd = -1;
+        if (!address.empty() && address.find_first_not_of("0123456789") == std::string::npos)
+        {
+            sockaddr_in addr;
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(parsePort(address));
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            fd = ::socket(AF_INET, SOCK_STREAM, 0);
+            const int reuse = 1;
+            if (fd >= 0)
+            {
+                ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            }
+            if (fd < 0 || ::bind(fd, (const sockaddr *)&addr, sizeof(addr)) != 0)
+            {
+                const std::string error = std::strerror(errno);
+                if (fd >= 0)
+                {
+                    ::close(fd);
+                }
+                throw std::runtime_error("cannot bind port " + address + ": " + error);
+            }
+        }
+        else
+        {
+            sockaddr_un addr;
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sun_family = AF_UNIX;
+            if (address.size() >= sizeof(addr.sun_path))
+            {
+                throw std::runtime_error("socket path \"" + address + "\" is too long");
+            }
+            std::strcpy(addr.sun_path, address.c_str());
+            fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            // a socket left behind by a previous run would make bind() fail; other files are never removed
+            if (isSocket(address))
+            {
+                ::unlink(address.c_str());
+            }
+            if (fd < 0 || ::bind(fd, (const sockaddr *)&addr, sizeof(addr)) != 0)
+            {
+                const std::string error = std::strerror(errno);
+                if (fd >= 0)
+                {
+                    ::close(fd);
+                }
+                throw std::runtime_error("cannot bind socket \"" + address + "\": " + error);
+            }
+            socketPath = address;
+        }
+        if (::listen(fd, backlog) != 0)
+        {
+            const std::string error = std::strerror(errno);
+            ::close(fd);
+            removeSocket(socketPath);
+            socketPath.clear();
+            throw std::runtime_error("cannot listen on \"" + address + "\": " + error);
+        }
+        return fd;
+    }
+
+    // @brief Removes a Unix socket created by listenOn(), unless the path no longer names a socket.
+    // @param socketPath The path of the socket, or empty for none.
+    void removeSocket(const std::string &socketPath)
+    {
+        if (!socketPath.empty() && isSocket(socketPath))
+        {
+            ::unlink(socketPath.c_str());
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef GRASP_SOCKET_HPP
+#define GRASP_SOCKET_HPP
+
+#include <string>
+
+namespace Metrics
+{
+    // @brief Opens a listening socket.
+    // @param address The path of a Unix domain socket, or a TCP port number bound on 127.0.0.1.
+    // @param backlog The length of the queue of pending connections.
+    // @param socketPath Receives the path of the Unix socket created, empty for TCP.
+    // @return The listening socket.
+    // @throws std::runtime_error If the port is out of range or the address cannot be bound.
+    // @details A socket left behind by a previous run is replaced, but any other kind of file at the path is kept and
+    //          makes the call fail.
+    int listenOn(const std::string &address, int backlog, std::string &socketPath);
+
+    // @brief Removes a Unix socket created by listenOn(), unless the path no longer names a socket.
+    // @param socketPath The path of the socket, or empty for none.
+    void removeSocket(const std::string &socketPath);
+}
+
+#endif
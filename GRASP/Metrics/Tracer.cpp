@@ -0,0 +1,154 @@
+#include "Tracer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Metrics
+{
+    namespace
+    {
+        // @brief A span recorded by a thread.
+        struct TraceEvent
+        {
+            const char *name; // Span name.
+            uint64_t start;   // Start on the trace clock, in nanoseconds.
+            uint64_t end;     // End on the trace clock, in nanoseconds.
+            const char *key;  // Name of the integer argument, or nullptr.
+            int arg;          // Integer argument.
+        };
+
+        // @brief Spans recorded by a single thread; only the owning thread appends to it.
+        struct ThreadBuffer
+        {
+            int tid;                        // Sequential identifier of the thread in the trace.
+            std::vector<TraceEvent> events; // Recorded spans.
+            uint64_t dropped;               // Number of spans dropped because the buffer was full.
+        };
+
+        std::atomic<bool> enabled(false);                    // Flag indicating if spans are recorded.
+        std::atomic<uint64_t> maxEvents(0);                  // Capacity of each thread buffer.
+        std::chrono::steady_clock::time_point epoch;         // Origin of the trace clock.
+        std::mutex registryMutex;                            // Mutex guarding the registry.
+        std::vector<std::unique_ptr<ThreadBuffer>> registry; // Buffers of every thread that recorded a span.
+        thread_local ThreadBuffer *localBuffer = nullptr;    // Buffer of the calling thread.
+
+        // @brief Writes a trace clock value in microseconds with nanosecond resolution.
+        // @param os The output stream.
+        // @param nanoseconds The value in nanoseconds.
+        void writeMicroseconds(std::ostream &os, const uint64_t nanoseconds)
+        {
+            os << nanoseconds / 1000 << "." << std::setw(3) << std::setfill('0') << nanoseconds % 1000 << std::setfill(' ');
+        }
+
+        // @brief Returns the calling thread's buffer, registering it on first use.
+        // @return The thread buffer.
+        ThreadBuffer *threadBuffer()
+        {
+            if (localBuffer == nullptr)
+            {
+                std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+                buffer->dropped = 0;
+                buffer->events.reserve(std::min<uint64_t>(maxEvents.load(std::memory_order_relaxed), 1 << 16));
+                std::lock_guard<std::mutex> lock(registryMutex);
+                buffer->tid = int(registry.size()) + 1;
+                localBuffer = buffer.get();
+                registry.push_back(std::move(buffer));
+            }
+            return localBuffer;
+        }
+    }
+
+    // @brief Starts recording spans.
+    // @param maxEventsPerThread The number of spans each thread may record; later spans are dropped and counted.
+    void Tracer::Enable(const uint64_t maxEventsPerThread)
+    {
+        epoch = std::chrono::steady_clock::now();
+        maxEvents.store(maxEventsPerThread, std::memory_order_relaxed);
+        enabled.store(true, std::memory_order_release);
+    }
+
+    // @brief Returns whether spans are being recorded.
+    // @return True if tracing is enabled.
+    bool Tracer::Enabled()
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    // @brief Returns the current time on the trace clock.
+    // @return The number of nanoseconds since tracing was enabled.
+    uint64_t Tracer::Now()
+    {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    // @brief Records a completed span on the calling thread's buffer.
+    // @param name The span name; it must outlive the tracer, e.g. a string literal.
+    // @param start The start of the span on the trace clock.
+    // @param end The end of the span on the trace clock.
+    // @param key The name of an integer argument shown with the span, or nullptr for none.
+    // @param arg The integer argument.
+    void Tracer::Record(const char *name, const uint64_t start, const uint64_t end, const char *key, const int arg)
+    {
+        ThreadBuffer *buffer = threadBuffer();
+        if (buffer->events.size() >= maxEvents.load(std::memory_order_relaxed))
+        {
+            ++buffer->dropped;
+            return;
+        }
+        buffer->events.push_back(TraceEvent{name, start, end, key, arg});
+    }
+
+    // @brief Writes every recorded span to a Chrome trace JSON file.
+    // @param path The path of the output file.
+    // @return True if the file was written.
+    bool Tracer::Export(const std::string &path)
+    {
+        std::ofstream ofs(path);
+        if (!ofs)
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        ofs << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        bool first = true;
+        for (const auto &buffer : registry)
+        {
+            ofs << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+                << ",\"args\":{\"name\":\"thread " << buffer->tid << "\"}}";
+            first = false;
+            for (const TraceEvent &event : buffer->events)
+            {
+                ofs << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"grasp\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid << ",\"ts\":";
+                writeMicroseconds(ofs, event.start);
+                ofs << ",\"dur\":";
+                writeMicroseconds(ofs, event.end - event.start);
+                if (event.key != nullptr)
+                {
+                    ofs << ",\"args\":{\"" << event.key << "\":" << event.arg << "}";
+                }
+                ofs << "}";
+            }
+        }
+        ofs << "\n]}" << std::endl;
+        return bool(ofs);
+    }
+
+    // @brief Returns the number of spans dropped because a thread buffer was full.
+    // @return The number of dropped spans.
+    uint64_t Tracer::DroppedCount()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        uint64_t dropped = 0;
+        for (const auto &buffer : registry)
+        {
+            dropped += buffer->dropped;
+        }
+        return dropped;
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef GRASP_TRACER_HPP
+#define GRASP_TRACER_HPP
+
+#include <cstdint>
+#include <string>
+
+namespace Metrics
+{
+    // @brief Records timed spans per thread and exports them in the Chrome trace event format.
+    // @details Each thread appends to its own buffer without synchronization; buffers are only registered under a lock
+    //          the first time a thread records a span. Export must happen while no traced thread is recording, e.g.
+    //          after training has finished. The resulting file can be opened in chrome://tracing or Perfetto.
+    class Tracer
+    {
+    public:
+        // @brief Starts recording spans.
+        // @param maxEventsPerThread The number of spans each thread may record; later spans are dropped and counted.
+        static void Enable(uint64_t maxEventsPerThread = 1 << 20);
+
+        // @brief Returns whether spans are being recorded.
+        // @return True if tracing is enabled.
+        static bool Enabled();
+
+        // @brief Returns the current time on the trace clock.
+        // @return The number of nanoseconds since tracing was enabled.
+        static uint64_t Now();
+
+        // @brief Records a completed span on the calling thread's buffer.
+        // @param name The span name; it must outlive the tracer, e.g. a string literal.
+        // @param start The start of the span on the trace clock.
+        // @param end The end of the span on the trace clock.
+        // @param key The name of an integer argument shown with the span, or nullptr for none.
+        // @param arg The integer argument.
+        static void Record(const char *name, uint64_t start, uint64_t end, const char *key, int arg);
+
+        // @brief Writes every recorded span to a Chrome trace JSON file.
+        // @param path The path of the output file.
+        // @return True if the file was written.
+        static bool Export(const std::string &path);
+
+        // @brief Returns the number of spans dropped because a thread buffer was full.
+        // @return The number of dropped spans.
+        static uint64_t DroppedCount();
+    };
+
+    // @brief Records the lifetime of the object as a span when tracing is enabled.
+    class ScopedSpan
+    {
+    public:
+        // @brief Starts a span.
+        // @param name The span name; it must outlive the tracer, e.g. a string literal.
+        // @param key The name of an integer argument shown with the span (e.g. "player"), or nullptr for none.
+        // @param arg The integer argument.
+        explicit ScopedSpan(const char *name, const char *key = nullptr, int arg = 0)
+            : mName(name), mKey(key), mArg(arg), mActive(Tracer::Enabled()), mStart(mActive ? Tracer::Now() : 0)
+        {
+        }
+
+        // @brief Ends the span and records it.
+        ~ScopedSpan()
+        {
+            if (mActive)
+            {
+                Tracer::Record(mName, mStart, Tracer::Now(), mKey, mArg);
+            }
+        }
+
+    private:
+        const char *mName; // Span name.
+        const char *mKey;  // Name of the integer argument, or nullptr.
+        int mArg;          // Integer argument of the span.
+        bool mActive;      // Flag indicating if tracing was enabled when the span started.
+        uint64_t mStart;   // Start of the span on the trace clock.
+    };
+}
+
+#endif
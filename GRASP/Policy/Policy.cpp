@@ -0,0 +1,207 @@
+#include "grasp_policy.h"
+#include <exception>
+#include <random>
+#include <string>
+#include "StrategySlot.hpp"
+#include "StrategyTable.hpp"
+
+// @brief A loaded strategy, swapped in place on reload.
+struct grasp_policy
+{
+    Agent::StrategySlot slot; // Current strategy table.
+
+    // @brief Constructs a policy serving the given table.
+    // @param table The initial table; the policy takes ownership.
+    explicit grasp_policy(const Agent::StrategyTable *table) : slot(table)
+    {
+    }
+};
+
+// Message of the last failure on each thread.
+static thread_local std::string lastError;
+
+// @brief Returns the random generator of the calling thread, seeding it randomly on first use.
+// @return The generator.
+static std::mt19937 &threadGenerator()
+{
+    static thread_local std::mt19937 generator(std::random_device{}());
+    return generator;
+}
+
+// @brief Looks up a key in a table.
+// @param table The table.
+// @param key The information set key.
+// @param keyLength The number of bytes of the key.
+// @return The row, or -1 if the key is unknown.
+static int findRow(const Agent::StrategyTable &table, const char *key, const size_t keyLength)
+{
+    // keys are short, so the copy usually stays in the small-string buffer
+    return table.find(std::string(key, keyLength));
+}
+
+// @brief Loads a strategy file written by the trainer.
+// @param path The path of the strategy file.
+// @return The policy, or NULL on failure (see grasp_policy_last_error).
+grasp_policy *grasp_policy_open(const char *path)
+{
+    if (path == nullptr)
+    {
+        lastError = "no strategy path given";
+        return nullptr;
+    }
+    try
+    {
+        return new grasp_policy(new Agent::StrategyTable(path));
+    }
+    catch (const std::exception &e)
+    {
+        lastError = std::string("cannot load \"") + path + "\": " + e.what();
+        return nullptr;
+    }
+}
+
+// @brief Frees a policy. No other call on the policy may be in progress.
+// @param policy The policy, or NULL.
+void grasp_policy_close(grasp_policy *policy)
+{
+    delete policy;
+}
+
+// @brief Loads a new strategy file into an open policy; calls in progress finish on the previous strategy.
+// @param policy The policy.
+// @param path The path of the strategy file.
+// @return 0 on success, -1 on failure, in which case the previous strategy stays in use.
+int grasp_policy_reload(grasp_policy *policy, const char *path)
+{
+    if (path == nullptr)
+    {
+        lastError = "no strategy path given";
+        return -1;
+    }
+    try
+    {
+        policy->slot.swap(new Agent::StrategyTable(path));
+        return 0;
+    }
+    catch (const std::exception &e)
+    {
+        lastError = std::string("cannot load \"") + path + "\": " + e.what();
+        return -1;
+    }
+}
+
+// @brief Returns the number of information sets of the current strategy.
+// @param policy The policy.
+// @return The number of information sets.
+size_t grasp_policy_size(const grasp_policy *policy)
+{
+    const Agent::StrategySlot::Reader table(policy->slot);
+    return table->size();
+}
+
+// @brief Looks up the action probabilities of an information set.
+// @param policy The policy.
+// @param key The information set key, as produced by the game's infoSetStr().
+// @param keyLength The number of bytes of the key.
+// @param probabilities Receives up to capacity probabilities; may be NULL if capacity is 0.
+// @param capacity The number of elements of probabilities.
+// @return The number of actions of the information set, or -1 if the key is unknown.
+int grasp_policy_lookup(const grasp_policy *policy, const char *key, const size_t keyLength, double *probabilities, const int capacity)
+{
+    int actionNum;
+    grasp_policy_lookup_batch(policy, &key, &keyLength, 1, probabilities, capacity, &actionNum);
+    return actionNum;
+}
+
+// @brief Samples an action of an information set with the calling thread's random generator.
+// @param policy The policy.
+// @param key The information set key.
+// @param keyLength The number of bytes of the key.
+// @return The sampled action, or -1 if the key is unknown.
+int grasp_policy_sample(const grasp_policy *policy, const char *key, const size_t keyLength)
+{
+    int action;
+    grasp_policy_sample_batch(policy, &key, &keyLength, 1, &action);
+    return action;
+}
+
+// @brief Looks up the action probabilities of a batch of information sets.
+// @param policy The policy.
+// @param keys The information set keys.
+// @param keyLengths The number of bytes of every key.
+// @param count The number of keys.
+// @param probabilities Receives stride probabilities per key; unused entries are left untouched.
+// @param stride The number of elements reserved per key in probabilities.
+// @param actionNums Receives the number of actions of every key, -1 for unknown keys.
+// @return The number of unknown keys.
+size_t grasp_policy_lookup_batch(const grasp_policy *policy, const char *const *keys, const size_t *keyLengths, const size_t count,
+                                 double *probabilities, const int stride, int *actionNums)
+{
+    // the whole batch is answered from one strategy, even if a reload completes meanwhile
+    const Agent::StrategySlot::Reader table(policy->slot);
+    size_t unknown = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const int row = findRow(*table, keys[i], keyLengths[i]);
+        if (row < 0)
+        {
+            ++unknown;
+            if (actionNums != nullptr)
+            {
+                actionNums[i] = -1;
+            }
+            continue;
+        }
+        const int actionNum = table->actionNum(row);
+        const double *probability = table->probability(row);
+        for (int a = 0; a < actionNum && a < stride; ++a)
+        {
+            probabilities[i * size_t(stride) + a] = probability[a];
+        }
+        if (actionNums != nullptr)
+        {
+            actionNums[i] = actionNum;
+        }
+    }
+    return unknown;
+}
+
+// @brief Samples an action for a batch of information sets with the calling thread's random generator.
+// @param policy The policy.
+// @param keys The information set keys.
+// @param keyLengths The number of bytes of every key.
+// @param count The number of keys.
+// @param actions Receives the sampled action of every key, -1 for unknown keys.
+// @return The number of unknown keys.
+size_t grasp_policy_sample_batch(const grasp_policy *policy, const char *const *keys, const size_t *keyLengths, const size_t count, int *actions)
+{
+    const Agent::StrategySlot::Reader table(policy->slot);
+    std::mt19937 &generator = threadGenerator();
+    size_t unknown = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const int row = findRow(*table, keys[i], keyLengths[i]);
+        if (row < 0)
+        {
+            ++unknown;
+            actions[i] = -1;
+            continue;
+        }
+        actions[i] = table->sample(row, double(generator()) / 4294967296.0);
+    }
+    return unknown;
+}
+
+// @brief Seeds the calling thread's random generator; threads that never call it are seeded randomly.
+// @param seed The seed.
+void grasp_policy_seed(const uint32_t seed)
+{
+    threadGenerator().seed(seed);
+}
+
+// @brief Returns the message of the last failure on the calling thread.
+// @return The message, or an empty string.
+const char *grasp_policy_last_error(void)
+{
+    return lastError.c_str();
+}
@@ -0,0 +1,94 @@
+#ifndef GRASP_POLICY_H
+#define GRASP_POLICY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// GRASP_POLICY_BUILD is defined while building the library itself, which exports the functions that consumers import.
+#if defined(_WIN32) && defined(GRASP_POLICY_BUILD)
+#define GRASP_POLICY_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define GRASP_POLICY_API __declspec(dllimport)
+#else
+#define GRASP_POLICY_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    // @brief A loaded strategy. Every function may be called from any number of threads at once.
+    typedef struct grasp_policy grasp_policy;
+
+    // @brief Loads a strategy file written by the trainer.
+    // @param path The path of the strategy file.
+    // @return The policy, or NULL on failure (see grasp_policy_last_error).
+    GRASP_POLICY_API grasp_policy *grasp_policy_open(const char *path);
+
+    // @brief Frees a policy. No other call on the policy may be in progress.
+    // @param policy The policy, or NULL.
+    GRASP_POLICY_API void grasp_policy_close(grasp_policy *policy);
+
+    // @brief Loads a new strategy file into an open policy; calls in progress finish on the previous strategy.
+    // @param policy The policy.
+    // @param path The path of the strategy file.
+    // @return 0 on success, -1 on failure, in which case the previous strategy stays in use.
+    GRASP_POLICY_API int grasp_policy_reload(grasp_policy *policy, const char *path);
+
+    // @brief Returns the number of information sets of the current strategy.
+    // @param policy The policy.
+    // @return The number of information sets.
+    GRASP_POLICY_API size_t grasp_policy_size(const grasp_policy *policy);
+
+    // @brief Looks up the action probabilities of an information set.
+    // @param policy The policy.
+    // @param key The information set key, as produced by the game's infoSetStr().
+    // @param keyLength The number of bytes of the key.
+    // @param probabilities Receives up to capacity probabilities; may be NULL if capacity is 0.
+    // @param capacity The number of elements of probabilities.
+    // @return The number of actions of the information set, or -1 if the key is unknown.
+    GRASP_POLICY_API int grasp_policy_lookup(const grasp_policy *policy, const char *key, size_t keyLength, double *probabilities, int capacity);
+
+    // @brief Samples an action of an information set with the calling thread's random generator.
+    // @param policy The policy.
+    // @param key The information set key.
+    // @param keyLength The number of bytes of the key.
+    // @return The sampled action, or -1 if the key is unknown.
+    GRASP_POLICY_API int grasp_policy_sample(const grasp_policy *policy, const char *key, size_t keyLength);
+
+    // @brief Looks up the action probabilities of a batch of information sets.
+    // @param policy The policy.
+    // @param keys The information set keys.
+    // @param keyLengths The number of bytes of every key.
+    // @param count The number of keys.
+    // @param probabilities Receives stride probabilities per key; unused entries are left untouched.
+    // @param stride The number of elements reserved per key in probabilities.
+    // @param actionNums Receives the number of actions of every key, -1 for unknown keys.
+    // @return The number of unknown keys.
+    GRASP_POLICY_API size_t grasp_policy_lookup_batch(const grasp_policy *policy, const char *const *keys, const size_t *keyLengths, size_t count,
+                                                      double *probabilities, int stride, int *actionNums);
+
+    // @brief Samples an action for a batch of information sets with the calling thread's random generator.
+    // @param policy The policy.
+    // @param keys The information set keys.
+    // @param keyLengths The number of bytes of every key.
+    // @param count The number of keys.
+    // @param actions Receives the sampled action of every key, -1 for unknown keys.
+    // @return The number of unknown keys.
+    GRASP_POLICY_API size_t grasp_policy_sample_batch(const grasp_policy *policy, const char *const *keys, const size_t *keyLengths, size_t count,
+                                                      int *actions);
+
+    // @brief Seeds the calling thread's random generator; threads that never call it are seeded randomly.
+    // @param seed The seed.
+    GRASP_POLICY_API void grasp_policy_seed(uint32_t seed);
+
+    // @brief Returns the message of the last failure on the calling thread.
+    // @return The message, or an empty string.
+    GRASP_POLICY_API const char *grasp_policy_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,335 @@
+#include "IncrementalExploitability.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace Trainer
+{
+    // @brief Expands the game tree below the given state.
+    // @param root The state the exploitability is evaluated from, typically a freshly reset game.
+    // @param tolerance The L1 change of an information set's strategy below which the cached strategy is kept.
+    template <typename Type>
+    IncrementalExploitability<Type>::IncrementalExploitability(const Type &root, const double tolerance)
+        : mTolerance(tolerance), mPlayerNum(root.playerNum()), mEvaluated(false), mRecomputed(0)
+    {
+        mDepth.resize(mPlayerNum);
+        std::vector<int> depth(mPlayerNum, 0);
+        expand(root, -1, 0, depth);
+
+        // children are appended after their whole subtree, so the offsets are rebuilt in index order
+        std::vector<std::vector<int>> children(mKind.size());
+        for (int h = 1; h < (int)mKind.size(); ++h)
+        {
+            children[mParent[h]].push_back(h);
+        }
+        mChildBegin.resize(mKind.size() + 1);
+        for (int h = 0; h < (int)mKind.size(); ++h)
+        {
+            mChildBegin[h] = (int)mChildren.size();
+            mChildren.insert(mChildren.end(), children[h].begin(), children[h].end());
+        }
+        mChildBegin[mKind.size()] = (int)mChildren.size();
+
+        mReach.assign(mPlayerNum, std::vector<double>(mKind.size(), 0.0));
+        mValue.assign(mPlayerNum, std::vector<double>(mKind.size(), 0.0));
+        mBestAction.assign(mPlayerNum, std::vector<int>(mInfoSets.size(), 0));
+        mQueued.assign(mKind.size(), 0);
+        mInfoSetQueued.assign(mInfoSets.size(), 0);
+    }
+
+    // @brief Calculates the exploitability of the given strategies.
+    // @param strategies A vector of functions that return the strategy for each player.
+    // @return The exploitability value, i.e. the sum of the best-response values of every player.
+    template <typename Type>
+    double IncrementalExploitability<Type>::evaluate(const std::vector<std::function<const double *(const Type &)>> &strategies)
+    {
+        // refresh the cached strategies that moved by more than the tolerance
+        std::vector<int> changed;
+        for (int i = 0; i < (int)mInfoSets.size(); ++i)
+        {
+            InfoSet &infoSet = mInfoSets[i];
+            const double *strategy = strategies[infoSet.player](infoSet.state);
+            double distance = 0.0;
+            for (int a = 0; a < infoSet.actionNum; ++a)
+            {
+                distance += std::abs(strategy[a] - infoSet.cached[a]);
+            }
+            if (!mEvaluated || distance > mTolerance)
+            {
+                infoSet.cached.assign(strategy, strategy + infoSet.actionNum);
+                changed.push_back(i);
+            }
+        }
+
+        mRecomputed = 0;
+        double exploitability = 0.0;
+        for (int p = 0; p < mPlayerNum; ++p)
+        {
+            std::vector<double> &reach = mReach[p];
+            if (!mEvaluated)
+            {
+                reach[0] = 1.0;
+                for (int h = 1; h < (int)mKind.size(); ++h)
+                {
+                    reach[h] = reach[mParent[h]] * edgeProbability(p, h);
+                }
+                for (int h = 0; h < (int)mKind.size(); ++h)
+                {
+                    push(p, h);
+                }
+            }
+            else
+            {
+                // the strategy of another player scales the reach of every history below its information set
+                for (const int i : changed)
+                {
+                    if (mInfoSets[i].player == p)
+                    {
+                        continue;
+                    }
+                    for (const int history : mInfoSets[i].histories)
+                    {
+                        for (int h = history + 1; h < mSubtreeEnd[history]; ++h)
+                        {
+                            reach[h] = reach[mParent[h]] * edgeProbability(p, h);
+                            push(p, h);
+                        }
+                    }
+                }
+            }
+            process(p);
+            exploitability += mValue[p][0];
+        }
+        mEvaluated = true;
+        return exploitability;
+    }
+
+    // @brief Returns the number of histories whose value was recomputed by the last evaluation.
+    // @return The number of recomputed histories.
+    template <typename Type>
+    uint64_t IncrementalExploitability<Type>::recomputedCount() const
+    {
+        return mRecomputed;
+    }
+
+    // @brief Returns the number of histories in the expanded game tree.
+    // @return The number of histories.
+    template <typename Type>
+    uint64_t IncrementalExploitability<Type>::historyCount() const
+    {
+        return mKind.size();
+    }
+
+    // @brief Returns the memory held by the expanded tree and the cached values.
+    // @return The number of bytes.
+    template <typename Type>
+    uint64_t IncrementalExploitability<Type>::memoryBytes() const
+    {
+        uint64_t bytes = mKind.capacity() * sizeof(uint8_t) + mQueued.capacity() + mInfoSetQueued.capacity();
+        bytes += (mParent.capacity() + mAction.capacity() + mSubtreeEnd.capacity() + mInfoSet.capacity() + mChildBegin.capacity() + mChildren.capacity()) * sizeof(int);
+        bytes += (mChance.capacity() + mPayoff.capacity()) * sizeof(double);
+        bytes += mQueue.capacity() * sizeof(std::tuple<int, int, int>);
+        for (int p = 0; p < mPlayerNum; ++p)
+        {
+            bytes += (mDepth[p].capacity() + mBestAction[p].capacity()) * sizeof(int);
+            bytes += (mReach[p].capacity() + mValue[p].capacity()) * sizeof(double);
+        }
+        for (const InfoSet &infoSet : mInfoSets)
+        {
+            bytes += sizeof(InfoSet) + infoSet.histories.capacity() * sizeof(int) + infoSet.cached.capacity() * sizeof(double);
+        }
+        for (const auto &itr : mInfoSetIndex)
+        {
+            bytes += sizeof(itr) + itr.first.capacity();
+        }
+        return bytes;
+    }
+
+    // @brief Appends a history and its subtree to the expanded tree.
+    // @param game The state of the history.
+    // @param parent The index of the parent history, or -1 for the root.
+    // @param action The action leading from the parent to this history.
+    // @param depth The number of own actions taken to reach this history, per player.
+    // @return The index of the history.
+    template <typename Type>
+    int IncrementalExploitability<Type>::expand(const Type &game, const int parent, const int action, std::vector<int> &depth)
+    {
+        const int history = (int)mKind.size();
+        mParent.push_back(parent);
+        mAction.push_back(action);
+        mSubtreeEnd.push_back(0);
+        mInfoSet.push_back(-1);
+        mChance.push_back(parent >= 0 && mKind[parent] == CHANCE ? game.chanceProbability() : 1.0);
+        for (int p = 0; p < mPlayerNum; ++p)
+        {
+            mDepth[p].push_back(depth[p]);
+        }
+
+        if (game.isGameOver())
+        {
+            mKind.push_back(TERMINAL);
+            mPayoff.resize(mKind.size() * mPlayerNum, 0.0);
+            for (int p = 0; p < mPlayerNum; ++p)
+            {
+                mPayoff[history * mPlayerNum + p] = game.payoff(p);
+            }
+            mSubtreeEnd[history] = history + 1;
+            return history;
+        }
+
+        const int actionNum = game.actionNum();
+        int player = -1;
+        if (game.isChanceNode())
+        {
+            mKind.push_back(CHANCE);
+        }
+        else
+        {
+            mKind.push_back(DECISION);
+            player = game.currentPlayer();
+            const std::string key = game.infoSetStr();
+            auto itr = mInfoSetIndex.find(key);
+            if (itr == mInfoSetIndex.end())
+            {
+                itr = mInfoSetIndex.emplace(key, (int)mInfoSets.size()).first;
+                mInfoSets.push_back(InfoSet{game, player, actionNum, std::vector<int>(), std::vector<double>(actionNum, 0.0)});
+            }
+            mInfoSet[history] = itr->second;
+            mInfoSets[itr->second].histories.push_back(history);
+        }
+        mPayoff.resize(mKind.size() * mPlayerNum, 0.0);
+
+        for (int a = 0; a < actionNum; ++a)
+        {
+            auto game_cp(game);
+            game_cp.takeAction(a);
+            if (player >= 0)
+            {
+                ++depth[player];
+            }
+            expand(game_cp, history, a, depth);
+            if (player >= 0)
+            {
+                --depth[player];
+            }
+        }
+        mSubtreeEnd[history] = (int)mKind.size();
+        return history;
+    }
+
+    // @brief Returns the probability with which the history is reached from its parent, seen by a best responder.
+    // @param player The best-responding player.
+    // @param history The index of the history.
+    // @return The chance probability or the cached action probability of another player, 1 for own actions.
+    template <typename Type>
+    double IncrementalExploitability<Type>::edgeProbability(const int player, const int history) const
+    {
+        const int parent = mParent[history];
+        if (mKind[parent] == CHANCE)
+        {
+            return mChance[history];
+        }
+        const InfoSet &infoSet = mInfoSets[mInfoSet[parent]];
+        return infoSet.player == player ? 1.0 : infoSet.cached[mAction[history]];
+    }
+
+    // @brief Queues a history, or its information set if the best-responding player acts there, for recomputation.
+    // @param player The best-responding player.
+    // @param history The index of the history.
+    template <typename Type>
+    void IncrementalExploitability<Type>::push(const int player, const int history)
+    {
+        const int i = mInfoSet[history];
+        if (i >= 0 && mInfoSets[i].player == player)
+        {
+            if (!mInfoSetQueued[i])
+            {
+                mInfoSetQueued[i] = 1;
+                mQueue.emplace_back(mDepth[player][history], 1, i);
+                std::push_heap(mQueue.begin(), mQueue.end());
+            }
+            return;
+        }
+        if (!mQueued[history])
+        {
+            mQueued[history] = 1;
+            mQueue.emplace_back(mDepth[player][history], 0, history);
+            std::push_heap(mQueue.begin(), mQueue.end());
+        }
+    }
+
+    // @brief Recomputes the queued histories and information sets of a best-responding player.
+    // @param player The best-responding player.
+    template <typename Type>
+    void IncrementalExploitability<Type>::process(const int player)
+    {
+        // deeper entries come first; within a depth, information sets precede histories, which come in reverse
+        // pre-order, so every child is final before its parent is recomputed
+        std::vector<double> &value = mValue[player];
+        while (!mQueue.empty())
+        {
+            std::pop_heap(mQueue.begin(), mQueue.end());
+            const std::tuple<int, int, int> entry = mQueue.back();
+            mQueue.pop_back();
+            const int index = std::get<2>(entry);
+
+            if (std::get<1>(entry) == 1)
+            {
+                mInfoSetQueued[index] = 0;
+                const InfoSet &infoSet = mInfoSets[index];
+                int bestAction = 0;
+                double bestValue = 0.0;
+                for (int a = 0; a < infoSet.actionNum; ++a)
+                {
+                    double actionValue = 0.0;
+                    for (const int h : infoSet.histories)
+                    {
+                        actionValue += value[mChildren[mChildBegin[h] + a]];
+                    }
+                    if (a == 0 || actionValue > bestValue)
+                    {
+                        bestAction = a;
+                        bestValue = actionValue;
+                    }
+                }
+                mBestAction[player][index] = bestAction;
+                for (const int h : infoSet.histories)
+                {
+                    ++mRecomputed;
+                    const double newValue = value[mChildren[mChildBegin[h] + bestAction]];
+                    if (newValue != value[h] || !mEvaluated)
+                    {
+                        value[h] = newValue;
+                        if (h > 0)
+                        {
+                            push(player, mParent[h]);
+                        }
+                    }
+                }
+                continue;
+            }
+
+            mQueued[index] = 0;
+            ++mRecomputed;
+            double newValue = 0.0;
+            if (mKind[index] == TERMINAL)
+            {
+                newValue = mReach[player][index] * mPayoff[index * mPlayerNum + player];
+            }
+            else
+            {
+                for (int c = mChildBegin[index]; c < mChildBegin[index + 1]; ++c)
+                {
+                    newValue += value[mChildren[c]];
+                }
+            }
+            if (newValue != value[index] || !mEvaluated)
+            {
+                value[index] = newValue;
+                if (index > 0)
+                {
+                    push(player, mParent[index]);
+                }
+            }
+        }
+    }
+}
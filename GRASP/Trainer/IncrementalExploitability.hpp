@@ -0,0 +1,116 @@
+#ifndef GRASP_INCREMENTALEXPLOITABILITY_HPP
+#define GRASP_INCREMENTALEXPLOITABILITY_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace Trainer
+{
+    // @brief Evaluates exploitability repeatedly, recomputing only the parts of the game tree affected by strategy changes.
+    // @details The game tree is expanded once into arrays in depth-first pre-order, so that every subtree is a contiguous
+    //          index range. For every best-responding player the evaluator caches the reach probability of the other
+    //          players and chance, the reach-weighted best-response value of every history and the best-response
+    //          action of every own information set. An evaluation compares each information set's strategy with the
+    //          one used last time; only those that moved by more than the tolerance (L1 distance) are refreshed. The
+    //          reach probabilities below a refreshed information set are recomputed, and values are re-aggregated
+    //          upwards through a priority queue ordered so that an information set's best response is always chosen
+    //          after every history below it is final. With a tolerance of 0 the result equals CalculateExploitability.
+    // @tparam Type The type of game being evaluated.
+    template <typename Type>
+    class IncrementalExploitability
+    {
+    public:
+        // @brief Expands the game tree below the given state.
+        // @param root The state the exploitability is evaluated from, typically a freshly reset game.
+        // @param tolerance The L1 change of an information set's strategy below which the cached strategy is kept.
+        IncrementalExploitability(const Type &root, double tolerance = 0.0);
+
+        // @brief Calculates the exploitability of the given strategies.
+        // @param strategies A vector of functions that return the strategy for each player.
+        // @return The exploitability value, i.e. the sum of the best-response values of every player.
+        double evaluate(const std::vector<std::function<const double *(const Type &)>> &strategies);
+
+        // @brief Returns the number of histories whose value was recomputed by the last evaluation.
+        // @return The number of recomputed histories.
+        uint64_t recomputedCount() const;
+
+        // @brief Returns the number of histories in the expanded game tree.
+        // @return The number of histories.
+        uint64_t historyCount() const;
+
+        // @brief Returns the memory held by the expanded tree and the cached values.
+        // @return The number of bytes.
+        uint64_t memoryBytes() const;
+
+    private:
+        // @brief Kinds of histories in the expanded tree.
+        enum Kind : uint8_t
+        {
+            TERMINAL,
+            CHANCE,
+            DECISION,
+        };
+
+        // @brief An information set of the expanded tree.
+        struct InfoSet
+        {
+            Type state;                 // One of the states of the information set, passed to the strategy functions.
+            int player;                 // Player acting at the information set.
+            int actionNum;              // Number of actions.
+            std::vector<int> histories; // Histories belonging to the information set.
+            std::vector<double> cached; // Strategy used by the cached values.
+        };
+
+        // @brief Appends a history and its subtree to the expanded tree.
+        // @param game The state of the history.
+        // @param parent The index of the parent history, or -1 for the root.
+        // @param action The action leading from the parent to this history.
+        // @param depth The number of own actions taken to reach this history, per player.
+        // @return The index of the history.
+        int expand(const Type &game, int parent, int action, std::vector<int> &depth);
+
+        // @brief Returns the probability with which the history is reached from its parent, seen by a best responder.
+        // @param player The best-responding player.
+        // @param history The index of the history.
+        // @return The chance probability or the cached action probability of another player, 1 for own actions.
+        double edgeProbability(int player, int history) const;
+
+        // @brief Queues a history, or its information set if the best-responding player acts there, for recomputation.
+        // @param player The best-responding player.
+        // @param history The index of the history.
+        void push(int player, int history);
+
+        // @brief Recomputes the queued histories and information sets of a best-responding player.
+        // @param player The best-responding player.
+        void process(int player);
+
+        std::vector<uint8_t> mKind;                         // Kind of every history.
+        std::vector<int> mParent;                           // Parent of every history, -1 for the root.
+        std::vector<int> mAction;                           // Action leading from the parent to every history.
+        std::vector<int> mSubtreeEnd;                       // One past the last index of every history's subtree.
+        std::vector<int> mInfoSet;                          // Information set of every decision history, -1 otherwise.
+        std::vector<int> mChildBegin;                       // Offset of every history's children in mChildren.
+        std::vector<int> mChildren;                         // Children of every history, in action order.
+        std::vector<double> mChance;                        // Probability of every chance outcome, 1 for other histories.
+        std::vector<double> mPayoff;                        // Payoff of every player at terminal histories, playerNum values per history.
+        std::vector<InfoSet> mInfoSets;                     // Information sets of the expanded tree.
+        std::unordered_map<std::string, int> mInfoSetIndex; // Index of every information set key.
+        std::vector<std::vector<int>> mDepth;               // Own actions taken to reach every history, per player.
+        std::vector<std::vector<double>> mReach;            // Reach probability of chance and the other players, per player.
+        std::vector<std::vector<double>> mValue;            // Reach-weighted best-response value of every history, per player.
+        std::vector<std::vector<int>> mBestAction;          // Best-response action of every information set, per player.
+        std::vector<uint8_t> mQueued;                       // Flags of the histories queued for recomputation.
+        std::vector<uint8_t> mInfoSetQueued;                // Flags of the information sets queued for recomputation.
+        std::vector<std::tuple<int, int, int>> mQueue;      // Heap of (depth, is information set, index) entries.
+        double mTolerance;                                  // L1 change below which a cached strategy is kept.
+        int mPlayerNum;                                     // Number of players.
+        bool mEvaluated;                                    // Flag indicating if the caches hold a complete evaluation.
+        uint64_t mRecomputed;                               // Histories recomputed by the last evaluation.
+    };
+}
+
+#endif
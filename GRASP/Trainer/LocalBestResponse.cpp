@@ -0,0 +1,243 @@
+#include "LocalBestResponse.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace Trainer
+{
+    // @brief Constructs an estimator.
+    // @param config The sampling settings.
+    template <typename Type>
+    LocalBestResponse<Type>::LocalBestResponse(const LocalBestResponseConfig &config) : mConfig(config)
+    {
+        mConfig.beliefSamples = std::max(1, mConfig.beliefSamples);
+        mConfig.rollouts = std::max(1, mConfig.rollouts);
+        mConfig.threadNum = std::max(1, mConfig.threadNum);
+    }
+
+    // @brief Estimates the exploitability of the given strategies.
+    // @param strategies A vector of functions that return the strategy for each player.
+    // @return The estimate and its confidence interval.
+    template <typename Type>
+    LocalBestResponseResult LocalBestResponse<Type>::evaluate(const std::vector<std::function<const double *(const Type &)>> &strategies) const
+    {
+        const int playerNum = Type::playerNum();
+        std::vector<std::vector<double>> sums(mConfig.threadNum, std::vector<double>(playerNum, 0.0));
+        std::vector<std::vector<double>> squares(mConfig.threadNum, std::vector<double>(playerNum, 0.0));
+        std::vector<std::vector<uint64_t>> counts(mConfig.threadNum, std::vector<uint64_t>(playerNum, 0));
+
+        // hand h seats the responder at h % playerNum and is played by thread h % threadNum
+        std::vector<std::thread> workers;
+        for (int t = 0; t < mConfig.threadNum; ++t)
+        {
+            workers.emplace_back([&, t]()
+                                 {
+                                     std::mt19937 engine(mConfig.seed + uint32_t(t));
+                                     Type root(engine);
+                                     for (uint64_t h = uint64_t(t); h < mConfig.hands; h += uint64_t(mConfig.threadNum))
+                                     {
+                                         const int responder = int(h % uint64_t(playerNum));
+                                         const double payoff = playHand(root, responder, strategies, engine);
+                                         sums[t][responder] += payoff;
+                                         squares[t][responder] += payoff * payoff;
+                                         ++counts[t][responder];
+                                     } });
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+
+        LocalBestResponseResult result;
+        result.hands = mConfig.hands;
+        result.value.assign(playerNum, 0.0);
+        result.stdErr.assign(playerNum, 0.0);
+        result.exploitability = 0.0;
+        double variance = 0.0;
+        for (int p = 0; p < playerNum; ++p)
+        {
+            double sum = 0.0, square = 0.0;
+            uint64_t count = 0;
+            for (int t = 0; t < mConfig.threadNum; ++t)
+            {
+                sum += sums[t][p];
+                square += squares[t][p];
+                count += counts[t][p];
+            }
+            if (count == 0)
+            {
+                continue;
+            }
+            const double mean = sum / double(count);
+            const double sampleVariance = count > 1 ? std::max(0.0, (square - double(count) * mean * mean) / double(count - 1)) : 0.0;
+            result.value[p] = mean;
+            result.stdErr[p] = std::sqrt(sampleVariance / double(count));
+            result.exploitability += mean;
+            variance += result.stdErr[p] * result.stdErr[p];
+        }
+        result.halfWidth = 1.96 * std::sqrt(variance);
+        return result;
+    }
+
+    // @brief Plays one hand with the responder in the given seat.
+    // @param root A state whose resetGame() deals a new hand from the thread's random generator.
+    // @param responder The seat of the responder.
+    // @param strategies A vector of functions that return the strategy for each player.
+    // @param engine The thread's random generator.
+    // @return The payoff of the responder.
+    template <typename Type>
+    double LocalBestResponse<Type>::playHand(const Type &root, const int responder, const std::vector<std::function<const double *(const Type &)>> &strategies, std::mt19937 &engine) const
+    {
+        auto game(root);
+        game.resetGame();
+        std::vector<int> history;
+        while (!game.isGameOver())
+        {
+            const int action = !game.isChanceNode() && game.currentPlayer() == responder
+                                   ? chooseAction(root, game, history, strategies, engine)
+                                   : SampleAction(game, strategies, engine);
+            history.push_back(action);
+            game.takeAction(action);
+        }
+        return game.payoff(responder);
+    }
+
+    // @brief Chooses the action with the largest expected value under the responder's estimated belief.
+    // @param root A state whose resetGame() deals a new hand from the thread's random generator.
+    // @param game The current state, at a decision of the responder.
+    // @param history The actions taken since the deal.
+    // @param strategies A vector of functions that return the strategy for each player.
+    // @param engine The thread's random generator.
+    // @return The chosen action.
+    template <typename Type>
+    int LocalBestResponse<Type>::chooseAction(const Type &root, const Type &game, const std::vector<int> &history, const std::vector<std::function<const double *(const Type &)>> &strategies, std::mt19937 &engine) const
+    {
+        const int responder = game.currentPlayer();
+        const int actionNum = game.actionNum();
+        const std::string infoSet = game.infoSetStr();
+
+        double values[actionNum];
+        for (int a = 0; a < actionNum; ++a)
+        {
+            values[a] = 0.0;
+        }
+        double totalWeight = 0.0;
+        for (int s = 0; s < mConfig.beliefSamples; ++s)
+        {
+            // replay the observed actions on a fresh deal; chance outcomes after the deal are resampled as well
+            auto sample(root);
+            sample.resetGame();
+            double weight = 1.0;
+            for (size_t i = 0; i < history.size() && weight > 0.0; ++i)
+            {
+                if (sample.isGameOver() || sample.actionNum() <= history[i])
+                {
+                    weight = 0.0;
+                    break;
+                }
+                int action = history[i];
+                if (sample.isChanceNode())
+                {
+                    action = SampleAction(sample, strategies, engine);
+                }
+                else if (sample.currentPlayer() != responder)
+                {
+                    weight *= strategies[sample.currentPlayer()](sample)[action];
+                }
+                sample.takeAction(action);
+            }
+            if (weight <= 0.0 || sample.isGameOver() || sample.isChanceNode() || sample.currentPlayer() != responder || sample.infoSetStr() != infoSet)
+            {
+                continue;
+            }
+
+            totalWeight += weight;
+            for (int a = 0; a < actionNum; ++a)
+            {
+                double value = 0.0;
+                for (int r = 0; r < mConfig.rollouts; ++r)
+                {
+                    auto next(sample);
+                    next.takeAction(a);
+                    value += Rollout(next, responder, strategies, engine);
+                }
+                values[a] += weight * value / double(mConfig.rollouts);
+            }
+        }
+
+        // without a consistent sample the responder follows the evaluated strategy, which keeps the estimate a lower bound
+        if (totalWeight <= 0.0)
+        {
+            return SampleAction(game, strategies, engine);
+        }
+        return int(std::max_element(values, values + actionNum) - values);
+    }
+
+    // @brief Plays a state to the end with every player following the strategies.
+    // @param game The state to start from.
+    // @param player The player whose payoff is returned.
+    // @param strategies A vector of functions that return the strategy for each player.
+    // @param engine The thread's random generator.
+    // @return The payoff of the player.
+    template <typename Type>
+    double LocalBestResponse<Type>::Rollout(Type game, const int player, const std::vector<std::function<const double *(const Type &)>> &strategies, std::mt19937 &engine)
+    {
+        while (!game.isGameOver())
+        {
+            game.takeAction(SampleAction(game, strategies, engine));
+        }
+        return game.payoff(player);
+    }
+
+    // @brief Samples an action of a chance node or a player.
+    // @param game The current state.
+    // @param strategies A vector of functions that return the strategy for each player.
+    // @param engine The thread's random generator.
+    // @return The sampled action.
+    template <typename Type>
+    int LocalBestResponse<Type>::SampleAction(const Type &game, const std::vector<std::function<const double *(const Type &)>> &strategies, std::mt19937 &engine)
+    {
+        const int actionNum = game.actionNum();
+        double probability[actionNum];
+        if (game.isChanceNode())
+        {
+            for (int a = 0; a < actionNum; ++a)
+            {
+                auto game_cp(game);
+                game_cp.takeAction(a);
+                probability[a] = game_cp.chanceProbability();
+            }
+        }
+        else
+        {
+            const double *strategy = strategies[game.currentPlayer()](game);
+            for (int a = 0; a < actionNum; ++a)
+            {
+                probability[a] = strategy[a];
+            }
+        }
+
+        double total = 0.0;
+        for (int a = 0; a < actionNum; ++a)
+        {
+            total += probability[a];
+        }
+        const double r = std::uniform_real_distribution<double>(0.0, total)(engine);
+        double cumulative = 0.0;
+        int last = 0;
+        for (int a = 0; a < actionNum; ++a)
+        {
+            if (probability[a] <= 0.0)
+            {
+                continue;
+            }
+            cumulative += probability[a];
+            last = a;
+            if (r < cumulative)
+            {
+                return a;
+            }
+        }
+        return last;
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef GRASP_LOCALBESTRESPONSE_HPP
+#define GRASP_LOCALBESTRESPONSE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace Trainer
+{
+    // @brief Sampling settings of a local best-response estimate.
+    struct LocalBestResponseConfig
+    {
+        uint64_t hands;    // Number of hands played, spread evenly over the seats of the responder.
+        int beliefSamples; // Number of deals sampled to estimate the responder's belief at each of its decisions.
+        int rollouts;      // Number of rollouts per belief sample and action.
+        int threadNum;     // Number of threads playing hands.
+        uint32_t seed;     // Seed of the random generators; thread t uses seed + t.
+    };
+
+    // @brief Result of a local best-response estimate.
+    struct LocalBestResponseResult
+    {
+        uint64_t hands;             // Number of hands played.
+        std::vector<double> value;  // Mean payoff of the responder in each seat.
+        std::vector<double> stdErr; // Standard error of each mean.
+        double exploitability;      // Sum of the means, a lower bound on the exploitability in expectation.
+        double halfWidth;           // Half-width of the 95% confidence interval of the exploitability.
+    };
+
+    // @brief Estimates exploitability from below by playing a greedy one-step responder against fixed strategies.
+    // @details Local best response (Lisy and Bowling, 2017) takes, at each of its decisions, the action with the largest
+    //          expected value under its belief about the hidden state, assuming everyone, itself included, then
+    //          follows the evaluated strategies. The belief is estimated generically: deals are resampled with
+    //          resetGame(), the observed action sequence is replayed, samples whose information set differs are
+    //          rejected and the rest are weighted by the probability of the other players' replayed actions. The
+    //          responder's mean payoff is a lower bound on its best-response value, so the sum over seats bounds the
+    //          exploitability of CalculateExploitability from below without traversing the game tree. Hands are played
+    //          on several threads; the strategy functions must therefore be safe to call concurrently.
+    // @tparam Type The type of game being evaluated.
+    template <typename Type>
+    class LocalBestResponse
+    {
+    public:
+        // @brief Constructs an estimator.
+        // @param config The sampling settings.
+        explicit LocalBestResponse(const LocalBestResponseConfig &config);
+
+        // @brief Estimates the exploitability of the given strategies.
+        // @param strategies A vector of functions that return the strategy for each player.
+        // @return The estimate and its confidence interval.
+        LocalBestResponseResult evaluate(const std::vector<std::function<const double *(const Type &)>> &strategies) const;
+
+    private:
+        // @brief Plays one hand with the responder in the given seat.
+        // @param root A state whose resetGame() deals a new hand from the thread's random generator.
+        // @param responder The seat of the responder.
+        // @param strategies A vector of functions that return the strategy for each player.
+        // @param engine The thread's random generator.
+        // @return The payoff of the responder.
+        double playHand(const Type &root, int responder, const std::vector<std::function<const double *(const Type &)>> &strategies, std::mt19937 &engine) const;
+
+        // @brief Chooses the action with the largest expected value under the responder's estimated belief.
+        // @param root A state whose resetGame() deals a new hand from the thread's random generator.
+        // @param game The current state, at a decision of the responder.
+        // @param history The actions taken since the deal.
+        // @param strategies A vector of functions that return the strategy for each player.
+        // @param engine The thread's random generator.
+        // @return The chosen action.
+        int chooseAction(const Type &root, const Type &game, const std::vector<int> &history, const std::vector<std::function<const double *(const Type &)>> &strategies, std::mt19937 &engine) const;
+
+        // @brief Plays a state to the end with every player following the strategies.
+        // @param game The state to start from.
+        // @param player The player whose payoff is returned.
+        // @param strategies A vector of functions that return the strategy for each player.
+        // @param engine The thread's random generator.
+        // @return The payoff of the player.
+        static double Rollout(Type game, int player, const std::vector<std::function<const double *(const Type &)>> &strategies, std::mt19937 &engine);
+
+        // @brief Samples an action of a chance node or a player.
+        // @param game The current state.
+        // @param strategies A vector of functions that return the strategy for each player.
+        // @param engine The thread's random generator.
+        // @return The sampled action.
+        static int SampleAction(const Type &game, const std::vector<std::function<const double *(const Type &)>> &strategies, std::mt19937 &engine);
+
+        LocalBestResponseConfig mConfig; // Sampling settings.
+    };
+}
+
+#endif
@@ -0,0 +1,36 @@
+#include "MemoryReport.hpp"
+
+namespace Trainer
+{
+    // @brief Returns the total number of bytes accounted by the report.
+    // @return The sum of every byte count.
+    uint64_t MemoryReport::totalBytes() const
+    {
+        return nodeBytes + keyBytes + hashTableBytes + fixedStrategyBytes + exploitabilityBytes;
+    }
+
+    // @brief Writes the report in a human-readable form.
+    // @param os The output stream.
+    void MemoryReport::write(std::ostream &os) const
+    {
+        os << "memory report (bytes):" << std::endl;
+        os << "  node payloads:        " << nodeBytes << std::endl;
+        os << "  key storage:          " << keyBytes << std::endl;
+        os << "  hash table overhead:  " << hashTableBytes << std::endl;
+        os << "  fixed strategies:     " << fixedStrategyBytes << std::endl;
+        os << "  exploitability:       " << exploitabilityBytes << std::endl;
+        os << "  total:                " << totalBytes() << std::endl;
+        os << "node map: " << entries << " entries, " << bucketCount << " buckets, load factor " << loadFactor << " (max " << maxLoadFactor
+           << "), " << emptyBuckets << " empty buckets, bucket length max " << maxBucketLength << " mean " << meanBucketLength << std::endl;
+    }
+
+    // @brief Returns the bytes used by a string key, including heap storage beyond the small-string buffer.
+    // @param key The key.
+    // @return The number of bytes.
+    uint64_t KeyBytes(const std::string &key)
+    {
+        // an empty string's capacity is the size of the small-string buffer
+        const bool isHeap = key.capacity() > std::string().capacity();
+        return sizeof(std::string) + (isHeap ? key.capacity() + 1 : 0);
+    }
+}
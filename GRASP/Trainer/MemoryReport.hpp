@@ -0,0 +1,54 @@
+#ifndef GRASP_MEMORYREPORT_HPP
+#define GRASP_MEMORYREPORT_HPP
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace Trainer
+{
+    // @brief Breakdown of the memory held by a trainer.
+    // @details Hash table figures estimate the libstdc++ layout: one bucket pointer per bucket and, per entry, a next
+    //          pointer, the cached hash and the key/value pair.
+    struct MemoryReport
+    {
+        uint64_t nodeBytes;           // Node objects and their per-action arrays.
+        uint64_t keyBytes;            // Information set keys, including heap storage of long keys.
+        uint64_t hashTableBytes;      // Bucket arrays and per-entry overhead of the node map.
+        uint64_t fixedStrategyBytes;  // Nodes, keys and hash tables of the fixed-strategy maps.
+        uint64_t exploitabilityBytes; // Information set table built by the last exploitability evaluation.
+        uint64_t entries;             // Number of entries in the node map.
+        uint64_t bucketCount;         // Number of buckets in the node map.
+        double loadFactor;            // Entries per bucket of the node map.
+        double maxLoadFactor;         // Load factor above which the node map rehashes.
+        uint64_t emptyBuckets;        // Number of empty buckets in the node map.
+        uint64_t maxBucketLength;     // Length of the longest bucket chain in the node map.
+        double meanBucketLength;      // Mean chain length over the non-empty buckets of the node map.
+
+        // @brief Returns the total number of bytes accounted by the report.
+        // @return The sum of every byte count.
+        uint64_t totalBytes() const;
+
+        // @brief Writes the report in a human-readable form.
+        // @param os The output stream.
+        void write(std::ostream &os) const;
+    };
+
+    // @brief Returns the bytes used by a string key, including heap storage beyond the small-string buffer.
+    // @param key The key.
+    // @return The number of bytes.
+    uint64_t KeyBytes(const std::string &key);
+
+    // @brief Returns the bucket array and per-entry overhead of an unordered map, excluding the keys (see KeyBytes).
+    // @tparam Map The unordered map type.
+    // @param map The map.
+    // @return The number of bytes.
+    template <typename Map>
+    uint64_t HashTableBytes(const Map &map)
+    {
+        const uint64_t entryBytes = sizeof(void *) + sizeof(size_t) + sizeof(typename Map::value_type) - sizeof(typename Map::key_type);
+        return uint64_t(map.bucket_count()) * sizeof(void *) + uint64_t(map.size()) * entryBytes;
+    }
+}
+
+#endif
@@ -1,4 +1,5 @@
 #include "Node.hpp"
+#include <cmath>
 
 namespace Trainer
 {
@@ -17,6 +18,15 @@ namespace Trainer
             mStrategySum[a] = 0.0;
             mAverageStrategy[a] = 0.0;
         }
+#ifdef GRASP_NODE_STATS
+        mVisits = 0;
+        mRegretUpdates = 0;
+        mReportStrategy = new double[actionNum];
+        for (int a = 0; a < actionNum; ++a)
+        {
+            mReportStrategy[a] = 1.0 / (double)actionNum;
+        }
+#endif
     }
 
     // @brief Destructor for Node, responsible for deallocating dynamic memory.
@@ -26,6 +36,9 @@ namespace Trainer
         delete[] mCurrentStrategy;
         delete[] mStrategySum;
         delete[] mAverageStrategy;
+#ifdef GRASP_NODE_STATS
+        delete[] mReportStrategy;
+#endif
     }
 
     // @brief Returns the current strategy for this node.
@@ -101,6 +114,21 @@ namespace Trainer
         strategyNeedsUpdate = true;
     }
 
+    // @brief Returns the largest positive cumulative regret over the actions of this node.
+    // @return The largest cumulative regret, or 0 if no action has a positive regret.
+    double Node::positiveRegret() const
+    {
+        double regret = 0.0;
+        for (int a = 0; a < mActionNum; ++a)
+        {
+            if (mRegretSum[a] > regret)
+            {
+                regret = mRegretSum[a];
+            }
+        }
+        return regret;
+    }
+
     // @brief Returns the number of actions available at this node.
     // @return The number of actions as an unsigned 8-bit integer.
     uint8_t Node::actionNum() const
@@ -108,6 +136,67 @@ namespace Trainer
         return mActionNum;
     }
 
+    // @brief Returns the memory used by this node, including its per-action arrays.
+    // @return The number of bytes.
+    size_t Node::memoryBytes() const
+    {
+#ifdef GRASP_NODE_STATS
+        return sizeof(Node) + 5 * mActionNum * sizeof(double);
+#else
+        return sizeof(Node) + 4 * mActionNum * sizeof(double);
+#endif
+    }
+
+#ifdef GRASP_NODE_STATS
+    // @brief Records a visit of this node during a traversal.
+    // @param updatesRegret True if the traversal updates the regrets of this node.
+    void Node::visit(const bool updatesRegret)
+    {
+        ++mVisits;
+        if (updatesRegret)
+        {
+            ++mRegretUpdates;
+        }
+    }
+
+    // @brief Returns the number of visits of this node.
+    // @return The number of visits.
+    uint64_t Node::visits() const
+    {
+        return mVisits;
+    }
+
+    // @brief Returns the number of visits that updated the regrets of this node.
+    // @return The number of regret updates.
+    uint64_t Node::regretUpdates() const
+    {
+        return mRegretUpdates;
+    }
+
+    // @brief Returns the L1 distance between the average strategy and the one recorded at the last report.
+    // @return The strategy change since the last report.
+    double Node::strategyChange()
+    {
+        const double *average = averageStrategy();
+        double change = 0.0;
+        for (int a = 0; a < mActionNum; ++a)
+        {
+            change += std::abs(average[a] - mReportStrategy[a]);
+        }
+        return change;
+    }
+
+    // @brief Records the current average strategy as the reference of the next strategyChange().
+    void Node::markReported()
+    {
+        const double *average = averageStrategy();
+        for (int a = 0; a < mActionNum; ++a)
+        {
+            mReportStrategy[a] = average[a];
+        }
+    }
+#endif
+
     // @brief Calculates the average strategy based on the cumulative strategy sums.
     void Node::calcAverageStrategy()
     {
@@ -46,10 +46,39 @@ namespace Trainer
         // @param value The new regret value to set.
         void regretSum(int chooseAction, double value);
 
+        // @brief Returns the largest positive cumulative regret over the actions of this node.
+        // @return The largest cumulative regret, or 0 if no action has a positive regret.
+        double positiveRegret() const;
+
         // @brief Returns the number of possible actions for this node.
         // @return The number of actions as an unsigned 8-bit integer.
         uint8_t actionNum() const;
 
+        // @brief Returns the memory used by this node, including its per-action arrays.
+        // @return The number of bytes.
+        size_t memoryBytes() const;
+
+#ifdef GRASP_NODE_STATS
+        // @brief Records a visit of this node during a traversal.
+        // @param updatesRegret True if the traversal updates the regrets of this node.
+        void visit(bool updatesRegret);
+
+        // @brief Returns the number of visits of this node.
+        // @return The number of visits.
+        uint64_t visits() const;
+
+        // @brief Returns the number of visits that updated the regrets of this node.
+        // @return The number of regret updates.
+        uint64_t regretUpdates() const;
+
+        // @brief Returns the L1 distance between the average strategy and the one recorded at the last report.
+        // @return The strategy change since the last report.
+        double strategyChange();
+
+        // @brief Records the current average strategy as the reference of the next strategyChange().
+        void markReported();
+#endif
+
     private:
         friend class boost::serialization::access;
 
@@ -85,6 +114,14 @@ namespace Trainer
             }
             alreadyCalculated = true;
             strategyNeedsUpdate = false;
+#ifdef GRASP_NODE_STATS
+            delete[] mReportStrategy;
+            mReportStrategy = new double[vec.size()];
+            for (int i = 0; i < vec.size(); ++i)
+            {
+                mReportStrategy[i] = vec[i];
+            }
+#endif
         }
 
         BOOST_SERIALIZATION_SPLIT_MEMBER()
@@ -96,8 +133,21 @@ namespace Trainer
         double *mAverageStrategy; // Array holding the average strategy.
         bool alreadyCalculated;   // Flag indicating if the average strategy has been calculated.
         bool strategyNeedsUpdate; // Flag indicating if the strategy needs to be updated.
+#ifdef GRASP_NODE_STATS
+        uint64_t mVisits;         // Number of visits during traversals.
+        uint64_t mRegretUpdates;  // Number of visits that updated the regrets.
+        double *mReportStrategy;  // Average strategy at the last report.
+#endif
     };
 
 }
 
+// GRASP_NODE_VISIT(node, updatesRegret) records a node visit when the build defines GRASP_NODE_STATS and expands to
+// nothing otherwise.
+#ifdef GRASP_NODE_STATS
+#define GRASP_NODE_VISIT(node, updatesRegret) (node)->visit(updatesRegret)
+#else
+#define GRASP_NODE_VISIT(node, updatesRegret)
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include "StoppingCriteria.hpp"
+
+namespace Trainer
+{
+    // @brief Constructs criteria with every condition disabled and evaluations every 1000 iterations.
+    StoppingCriteria::StoppingCriteria()
+        : maxIterations(0), maxSeconds(0.0), targetExploitability(0.0), exploitabilityInterval(1000), targetRegretBound(0.0)
+    {
+    }
+
+    // @brief Returns whether at least one condition can end training.
+    // @return True if any of the iteration, time, exploitability or regret-bound conditions is enabled.
+    bool StoppingCriteria::bounded() const
+    {
+        return maxIterations > 0 || maxSeconds > 0.0 || targetExploitability > 0.0 || targetRegretBound > 0.0;
+    }
+
+    // @brief Returns the name of a stop reason.
+    // @param reason The stop reason.
+    // @return The snake_case name of the reason.
+    const char *StopReasonName(const StopReason reason)
+    {
+        switch (reason)
+        {
+        case StopReason::ITERATIONS:
+            return "iterations";
+        case StopReason::WALL_TIME:
+            return "wall_time";
+        case StopReason::EXPLOITABILITY:
+            return "exploitability";
+        case StopReason::REGRET_BOUND:
+            return "regret_bound";
+        case StopReason::REQUESTED:
+            return "requested";
+        }
+        return "unknown";
+    }
+}
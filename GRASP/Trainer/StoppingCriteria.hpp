@@ -0,0 +1,44 @@
+#ifndef GRASP_STOPPINGCRITERIA_HPP
+#define GRASP_STOPPINGCRITERIA_HPP
+
+#include <cstdint>
+
+namespace Trainer
+{
+    // @brief Conditions ending a training run; a zero value disables a condition.
+    // @details Training stops as soon as any enabled condition holds. The exploitability target is checked on a
+    //          snapshot of the average strategies evaluated on a background thread, so the run continues while the
+    //          evaluation is in flight and stops a few iterations after the snapshot met the target.
+    struct StoppingCriteria
+    {
+        uint64_t maxIterations;          // Number of iterations to run.
+        double maxSeconds;               // Wall-clock budget in seconds.
+        double targetExploitability;     // Exploitability at or below which training stops.
+        uint64_t exploitabilityInterval; // Minimum number of iterations between two background evaluations.
+        double targetRegretBound;        // Regret-based exploitability bound at or below which training stops.
+
+        // @brief Constructs criteria with every condition disabled and evaluations every 1000 iterations.
+        StoppingCriteria();
+
+        // @brief Returns whether at least one condition can end training.
+        // @return True if any of the iteration, time, exploitability or regret-bound conditions is enabled.
+        bool bounded() const;
+    };
+
+    // @brief The condition that ended a training run.
+    enum class StopReason
+    {
+        ITERATIONS,     // The iteration count was reached.
+        WALL_TIME,      // The wall-clock budget was spent.
+        EXPLOITABILITY, // The exploitability target was reached.
+        REGRET_BOUND,   // The regret-bound target was reached.
+        REQUESTED,      // A stop was requested through the control endpoint.
+    };
+
+    // @brief Returns the name of a stop reason.
+    // @param reason The stop reason.
+    // @return The snake_case name of the reason.
+    const char *StopReasonName(StopReason reason);
+}
+
+#endif
@@ -1,11 +1,22 @@
 #include "Trainer.hpp"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <fstream>
+#include <tuple>
 #include <boost/archive/binary_iarchive.hpp>
 #include <boost/archive/binary_oarchive.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/serialization/unordered_map.hpp>
+#ifdef GRASP_COUNT_ALLOCATIONS
+#include "Allocation.hpp"
+#endif
+#include "ControlServer.hpp"
+#include "IncrementalExploitability.cpp"
+#include "MetricsSink.hpp"
 #include "Node.hpp"
+#include "Signal.hpp"
+#include "Tracer.hpp"
 
 namespace Trainer
 {
@@ -16,13 +27,22 @@ namespace Trainer
     // @param strategyPaths Paths to pre-existing strategies for players, if any.
     template <typename Type>
     Trainer<Type>::Trainer(const std::string &mode, const uint32_t seed, const std::vector<std::string> &strategyPaths)
-        : randomGenerator(seed), mNodeTouchedCnt(0), mModeStr(mode)
+        : randomGenerator(seed), mNodeTouchedCnt(0), mModeStr(mode), mMetricsSink(nullptr), mMetricsInterval(1000),
+          mIterationCounters(nullptr), mEvaluationCounters(nullptr), mLastIterationCounters(), mLastEvaluationCounters(),
+          mBackgroundCounters(), mLastMetricsIteration(0), mLastAllocationCount(0), mIncremental(nullptr), mControlServer(nullptr),
+          mControlInterval(1000), mIterationCnt(0), mTargetIterations(0), mLastExploitability(std::nan("")),
+          mLastExploitabilityIteration(0), mPendingExploitabilityIteration(0), mEvaluationStop(false), mCheckpointCnt(0),
+          mLastCheckpointIteration(0), mExploitabilityBytes(0), mLastMetricsSeconds(0.0), mLastMetricsNodes(0)
     {
+#ifdef GRASP_NODE_STATS
+        mNodeStatsTop = 20;
+#endif
         mGame = new Type(randomGenerator);
         mFolderPath = "../strategies/" + mGame->name();
         boost::filesystem::create_directories(mFolderPath);
         mFixedStrategies = new std::unordered_map<std::string, Node *>[mGame->playerNum()];
         mUpdate = new bool[mGame->playerNum()];
+        mPositiveRegret.assign(mGame->playerNum(), 0.0);
         for (int i = 0; i < mGame->playerNum(); ++i)
         {
             if (strategyPaths.size() >= i + 1 && !strategyPaths[i].empty())
@@ -45,6 +65,16 @@ namespace Trainer
     template <typename Type>
     Trainer<Type>::~Trainer()
     {
+        // the background evaluation may still read the incremental evaluator
+        if (mEvaluationThread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mEvaluationMutex);
+                mEvaluationStop = true;
+            }
+            mEvaluationCondition.notify_one();
+            mEvaluationThread.join();
+        }
         for (auto &itr : mNodeMap)
         {
             delete itr.second;
@@ -62,6 +92,9 @@ namespace Trainer
         }
         delete[] mFixedStrategies;
         delete[] mUpdate;
+        delete mIterationCounters;
+        delete mEvaluationCounters;
+        delete mIncremental;
         delete mGame;
     }
 
@@ -71,66 +104,75 @@ namespace Trainer
     // @return A vector of payoffs for each player.
     template <typename Type>
     std::vector<double> Trainer<Type>::CalculatePayoff(const Type &game, const std::vector<std::function<const double *(const Type &)>> &strategies)
+    {
+        std::vector<double> payoffs(game.playerNum());
+        CalculatePayoff(game, strategies, payoffs.data());
+        return payoffs;
+    }
+
+    // @brief Calculates the payoff for each player in a given game state into a caller-provided array.
+    // @param game The current state of the game.
+    // @param strategies A vector of functions that return the strategy for each player.
+    // @param payoffs An array receiving the payoff of each player.
+    template <typename Type>
+    void Trainer<Type>::CalculatePayoff(const Type &game, const std::vector<std::function<const double *(const Type &)>> &strategies, double *payoffs)
     {
 
         if (game.isGameOver())
         {
-            std::vector<double> payoffs(game.playerNum());
             for (int i = 0; i < game.playerNum(); ++i)
             {
                 payoffs[i] = game.payoff(i);
             }
-            return payoffs;
+            return;
         }
 
+        for (int i = 0; i < game.playerNum(); ++i)
+        {
+            payoffs[i] = 0.0;
+        }
+        double utils[game.playerNum()];
+
         const int actionNum = game.actionNum();
         if (game.isChanceNode())
         {
-            std::vector<double> nodeUtils(game.playerNum());
-            for (int i = 0; i < game.playerNum(); ++i)
-            {
-                nodeUtils[i] = 0.0;
-            }
             for (int a = 0; a < actionNum; ++a)
             {
                 auto game_cp(game);
                 game_cp.takeAction(a);
                 const double chanceProbability = game_cp.chanceProbability();
-                std::vector<double> utils = CalculatePayoff(game_cp, strategies);
+                CalculatePayoff(game_cp, strategies, utils);
                 for (int i = 0; i < game.playerNum(); ++i)
                 {
-                    nodeUtils[i] += chanceProbability * utils[i];
+                    payoffs[i] += chanceProbability * utils[i];
                 }
             }
-            return nodeUtils;
+            return;
         }
 
         const int player = game.currentPlayer();
-        std::vector<double> nodeUtils(game.playerNum());
-        for (int i = 0; i < game.playerNum(); ++i)
-        {
-            nodeUtils[i] = 0.0;
-        }
+        const double *strategy = strategies[player](game);
         for (int a = 0; a < actionNum; ++a)
         {
             auto game_cp(game);
             game_cp.takeAction(a);
-            std::vector<double> utils = CalculatePayoff(game_cp, strategies);
+            CalculatePayoff(game_cp, strategies, utils);
             for (int i = 0; i < game.playerNum(); ++i)
             {
-                nodeUtils[i] += strategies[player](game)[a] * utils[i];
+                payoffs[i] += strategy[a] * utils[i];
             }
         }
-        return nodeUtils;
     }
 
     // @brief Calculates the exploitability of the current strategies in the game.
     // @param game The current state of the game.
     // @param strategies A vector of functions that return the strategy for each player.
+    // @param tableBytes If not nullptr, receives the memory used by the information set and best-response tables.
     // @return The exploitability value.
     template <typename Type>
-    double Trainer<Type>::CalculateExploitability(const Type &game, const std::vector<std::function<const double *(const Type &)>> &strategies)
+    double Trainer<Type>::CalculateExploitability(const Type &game, const std::vector<std::function<const double *(const Type &)>> &strategies, uint64_t *tableBytes)
     {
+        Metrics::ScopedSpan span("exploitability");
         InfoSets infoSets;
         for (int p = 0; p < game.playerNum(); ++p)
         {
@@ -140,12 +182,31 @@ namespace Trainer
         }
 
         double exploitability = 0.0;
+        uint64_t bestResponseBytes = 0;
         for (int p = 0; p < game.playerNum(); ++p)
         {
             auto game_cp(game);
             game_cp.resetGame(false);
             std::unordered_map<std::string, std::vector<double>> bestResponseStrategies;
             exploitability += CalculateBestResponseValue(game_cp, p, strategies, bestResponseStrategies, 1.0, infoSets);
+            if (tableBytes != nullptr)
+            {
+                uint64_t bytes = HashTableBytes(bestResponseStrategies);
+                for (auto &itr : bestResponseStrategies)
+                {
+                    bytes += KeyBytes(itr.first) + itr.second.capacity() * sizeof(double);
+                }
+                bestResponseBytes = std::max(bestResponseBytes, bytes);
+            }
+        }
+
+        if (tableBytes != nullptr)
+        {
+            *tableBytes = HashTableBytes(infoSets) + bestResponseBytes;
+            for (auto &itr : infoSets)
+            {
+                *tableBytes += KeyBytes(itr.first) + itr.second.capacity() * sizeof(std::tuple<Type, double>);
+            }
         }
         return exploitability;
     }
@@ -309,70 +370,627 @@ namespace Trainer
     }
 
     // @brief Trains the strategies using CFR for a specified number of iterations.
+    // @details Unlike StoppingCriteria::maxIterations, 0 does not mean "no limit": the call returns at once, without
+    //          training or writing the final strategy.
     // @param iterations The number of iterations to run the CFR algorithm.
     template <typename Type>
-    void Trainer<Type>::train(const int iterations)
+    void Trainer<Type>::train(const uint64_t iterations)
+    {
+        if (iterations == 0)
+        {
+            return;
+        }
+        StoppingCriteria criteria;
+        criteria.maxIterations = iterations;
+        train(criteria);
+    }
+
+    // @brief Trains the strategies using CFR until one of the stopping criteria holds.
+    // @param criteria The stopping criteria.
+    // @return The condition that ended training.
+    template <typename Type>
+    StopReason Trainer<Type>::train(const StoppingCriteria &criteria)
     {
         double utils[mGame->playerNum()];
+        for (int p = 0; p < mGame->playerNum(); ++p)
+        {
+            utils[p] = 0.0;
+        }
 
-        for (int i = 0; i < iterations; ++i)
+        mTrainStart = std::chrono::steady_clock::now();
+        mTargetIterations = criteria.maxIterations > 0 ? mIterationCnt + criteria.maxIterations : 0;
+        mLastMetricsSeconds = 0.0;
+        mLastMetricsNodes = mNodeTouchedCnt;
+        mLastMetricsIteration = 0;
+#ifdef GRASP_COUNT_ALLOCATIONS
+        mLastAllocationCount = Metrics::allocationStats().count;
+#endif
+        if (mIterationCounters != nullptr)
         {
-            for (int p = 0; p < mGame->playerNum(); ++p)
+            mLastIterationCounters = mIterationCounters->read();
+            mIterationCounters->start();
+        }
+        StopReason reason = StopReason::ITERATIONS;
+        uint64_t i = 0;
+        while (criteria.maxIterations == 0 || i < criteria.maxIterations)
+        {
+            iterate(i, utils);
+            if (mMetricsSink != nullptr && i % mMetricsInterval == 0)
+            {
+                GRASP_PHASE_SCOPE(mPhaseProfile, Metrics::Phase::LOGGING);
+                writeMetrics(i, utils);
+            }
+            if (i != 0 && i % 10000000 == 0)
             {
-                if (!mUpdate[p])
+                checkpoint(i);
+            }
+            if (mControlServer != nullptr)
+            {
+                if (i % mControlInterval == 0)
                 {
-                    continue;
+                    publishStatus("training");
                 }
-                if (mModeStr == "standard")
+                if (mControlServer->consumeCheckpointRequest())
                 {
-                    mGame->resetGame(false);
-                    utils[p] = CFR(*mGame, p, 1.0, 1.0);
-                    for (auto &itr : mNodeMap)
-                    {
-                        itr.second->updateStrategy();
-                    }
+                    // named by the cumulative count, which is at least 1 here and never repeats across train() calls; 0
+                    // would name the final strategy
+                    checkpoint(mIterationCnt);
                 }
-                else
+            }
+            if (Metrics::consumeReportRequest())
+            {
+                memoryReport().write(std::cerr);
+#ifdef GRASP_NODE_STATS
+                writeNodeStats(i);
+#endif
+#ifdef GRASP_PHASE_TIMING
+                mPhaseProfile.write(std::cerr, std::chrono::duration<double>(std::chrono::steady_clock::now() - mTrainStart).count());
+#endif
+            }
+            ++i;
+
+            if (mControlServer != nullptr && mControlServer->stopRequested())
+            {
+                reason = StopReason::REQUESTED;
+                break;
+            }
+            if (criteria.maxSeconds > 0.0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - mTrainStart).count() >= criteria.maxSeconds)
+            {
+                reason = StopReason::WALL_TIME;
+                break;
+            }
+            if (criteria.targetRegretBound > 0.0 && regretBound(mIterationCnt) <= criteria.targetRegretBound)
+            {
+                reason = StopReason::REGRET_BOUND;
+                break;
+            }
+            if (criteria.targetExploitability > 0.0 && pollExploitability(criteria.exploitabilityInterval) && mLastExploitability <= criteria.targetExploitability)
+            {
+                reason = StopReason::EXPLOITABILITY;
+                break;
+            }
+        }
+        std::cerr << "training stopped (" << StopReasonName(reason) << ") after " << mIterationCnt << " iterations" << std::endl;
+
+        if (mIterationCounters != nullptr)
+        {
+            mIterationCounters->stop();
+        }
+        if (mPendingExploitability.valid())
+        {
+            mLastExploitability = mPendingExploitability.get();
+            mLastExploitabilityIteration = mPendingExploitabilityIteration;
+            mLastEvaluationCounters = mBackgroundCounters;
+        }
+        if (mMetricsSink != nullptr)
+        {
+            mMetricsSink->flush();
+        }
+        writeStrategyToBin();
+#ifdef GRASP_NODE_STATS
+        writeNodeStats(i);
+#endif
+#ifdef GRASP_PHASE_TIMING
+        mPhaseProfile.write(std::cerr, std::chrono::duration<double>(std::chrono::steady_clock::now() - mTrainStart).count());
+#endif
+        if (mControlServer != nullptr)
+        {
+            publishStatus("finished");
+        }
+        return reason;
+    }
+
+    // @brief Collects the result of the background exploitability evaluation and starts the next one when due.
+    // @param interval The minimum number of iterations between two evaluations.
+    // @return True if an evaluation has completed since the last call.
+    template <typename Type>
+    bool Trainer<Type>::pollExploitability(const uint64_t interval)
+    {
+        bool completed = false;
+        if (mPendingExploitability.valid())
+        {
+            if (mPendingExploitability.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            {
+                return false;
+            }
+            mLastExploitability = mPendingExploitability.get();
+            mLastExploitabilityIteration = mPendingExploitabilityIteration;
+            mLastEvaluationCounters = mBackgroundCounters;
+            completed = true;
+            std::cerr << "exploitability " << mLastExploitability << " after " << mLastExploitabilityIteration << " iterations" << std::endl;
+        }
+        if (mIterationCnt < mPendingExploitabilityIteration + interval)
+        {
+            return completed;
+        }
+
+        // the evaluation runs on a copy of the average strategies, so training continues meanwhile
+        std::vector<std::unordered_map<std::string, std::vector<double>>> snapshot(mGame->playerNum());
+        for (int p = 0; p < mGame->playerNum(); ++p)
+        {
+            const std::unordered_map<std::string, Node *> &nodeMap = mUpdate[p] ? mNodeMap : mFixedStrategies[p];
+            snapshot[p].reserve(nodeMap.size());
+            for (auto &itr : nodeMap)
+            {
+                const double *strategy = itr.second->averageStrategy();
+                snapshot[p].emplace(itr.first, std::vector<double>(strategy, strategy + itr.second->actionNum()));
+            }
+        }
+        auto game(*mGame);
+        game.resetGame(false);
+        mPendingExploitabilityIteration = mIterationCnt;
+        IncrementalExploitability<Type> *incremental = mIncremental;
+        std::function<double()> evaluation = [game, snapshot = std::move(snapshot), incremental]()
+        {
+            std::unordered_map<std::string, std::vector<double>> unvisited;
+            std::vector<std::function<const double *(const Type &)>> strategies(game.playerNum());
+            for (int p = 0; p < game.playerNum(); ++p)
+            {
+                const std::unordered_map<std::string, std::vector<double>> &strategyMap = snapshot[p];
+                strategies[p] = [&strategyMap, &unvisited](const Type &game)
                 {
-                    mGame->resetGame();
-                    if (mModeStr == "chance")
+                    const std::string infoSet = game.infoSetStr();
+                    auto itr = strategyMap.find(infoSet);
+                    if (itr != strategyMap.end())
                     {
-                        utils[p] = chanceSamplingCFR(*mGame, p, 1.0, 1.0);
-                        for (auto &itr : mNodeMap)
-                        {
-                            itr.second->updateStrategy();
-                        }
+                        return itr->second.data();
                     }
-                    else if (mModeStr == "external")
+                    std::vector<double> &strategy = unvisited[infoSet];
+                    strategy.assign(game.actionNum(), 1.0 / double(game.actionNum()));
+                    return (const double *)strategy.data();
+                };
+            }
+            return incremental != nullptr ? incremental->evaluate(strategies) : CalculateExploitability(game, strategies);
+        };
+
+        // evaluations share one long-lived thread, so that per-thread state such as trace buffers is not created anew
+        // for every evaluation
+        {
+            std::lock_guard<std::mutex> lock(mEvaluationMutex);
+            mEvaluationTask = std::move(evaluation);
+            mEvaluationPromise = std::promise<double>();
+            mPendingExploitability = mEvaluationPromise.get_future();
+        }
+        if (!mEvaluationThread.joinable())
+        {
+            mEvaluationThread = std::thread(&Trainer<Type>::runEvaluations, this);
+        }
+        mEvaluationCondition.notify_one();
+        return completed;
+    }
+
+    // @brief Body of the thread running the background exploitability evaluations one at a time.
+    template <typename Type>
+    void Trainer<Type>::runEvaluations()
+    {
+        // hardware counters only count the thread that opens them, so the evaluations are counted here
+        Metrics::PerfCounters *counters = mIterationCounters != nullptr ? new Metrics::PerfCounters() : nullptr;
+        std::unique_lock<std::mutex> lock(mEvaluationMutex);
+        while (true)
+        {
+            mEvaluationCondition.wait(lock, [this]()
+                                      { return mEvaluationStop || mEvaluationTask; });
+            if (mEvaluationStop)
+            {
+                delete counters;
+                return;
+            }
+            std::function<double()> evaluation = std::move(mEvaluationTask);
+            mEvaluationTask = nullptr;
+            std::promise<double> promise = std::move(mEvaluationPromise);
+            lock.unlock();
+            try
+            {
+                Metrics::CounterValues before;
+                if (counters != nullptr)
+                {
+                    before = counters->read();
+                    counters->start();
+                }
+                const double exploitability = evaluation();
+                if (counters != nullptr)
+                {
+                    // the counts are published before the result, so the training thread sees them once it has the result
+                    counters->stop();
+                    mBackgroundCounters = counters->read();
+                    for (int c = 0; c < (int)Metrics::Counter::NUM; ++c)
                     {
-                        utils[p] = externalSamplingCFR(*mGame, p);
+                        mBackgroundCounters.value[c] -= before.value[c];
                     }
-                    else if (mModeStr == "outcome")
+                }
+                promise.set_value(exploitability);
+            }
+            catch (...)
+            {
+                promise.set_exception(std::current_exception());
+            }
+            lock.lock();
+        }
+    }
+
+    // @brief Writes a checkpoint of the current strategies, pausing the iteration counters meanwhile.
+    // @param iteration The iteration at which the checkpoint is written.
+    template <typename Type>
+    void Trainer<Type>::checkpoint(const uint64_t iteration)
+    {
+        if (mIterationCounters != nullptr)
+        {
+            mIterationCounters->stop();
+        }
+        writeStrategyToBin(iteration);
+#ifdef GRASP_NODE_STATS
+        writeNodeStats(iteration);
+#endif
+        if (mIterationCounters != nullptr)
+        {
+            mIterationCounters->start();
+        }
+    }
+
+    // @brief Publishes the current status to the control server.
+    // @param state The training state.
+    template <typename Type>
+    void Trainer<Type>::publishStatus(const char *state)
+    {
+        Metrics::TrainingStatus status;
+        status.state = state;
+        status.iteration = mIterationCnt;
+        status.targetIterations = mTargetIterations;
+        status.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - mTrainStart).count();
+        status.nodesTouched = mNodeTouchedCnt;
+        status.nodesPerSecond = 0.0;
+        status.infoSetNum = mNodeMap.size();
+        status.memoryBytes = Metrics::residentMemoryBytes();
+        status.regretBound = regretBound(mIterationCnt);
+        status.hasExploitability = !std::isnan(mLastExploitability);
+        status.exploitability = mLastExploitability;
+        status.exploitabilityIteration = mLastExploitabilityIteration;
+        status.checkpointCount = mCheckpointCnt;
+        status.lastCheckpointIteration = mLastCheckpointIteration;
+        status.lastCheckpointPath = mLastCheckpointPath;
+        mControlServer->publish(status);
+    }
+
+    // @brief Sets the sink receiving training progress records.
+    // @param sink The sink to write to, or nullptr to disable progress records. The trainer does not take ownership.
+    // @param interval The number of iterations between two records.
+    template <typename Type>
+    void Trainer<Type>::setMetricsSink(Metrics::MetricsSink *sink, const uint64_t interval)
+    {
+        mMetricsSink = sink;
+        mMetricsInterval = interval > 0 ? interval : 1;
+    }
+
+    // @brief Attaches the local control endpoint.
+    // @param server The server, or nullptr to detach it. The trainer does not take ownership.
+    // @param interval The number of iterations between two status updates.
+    template <typename Type>
+    void Trainer<Type>::setControlServer(Metrics::ControlServer *server, const uint64_t interval)
+    {
+        mControlServer = server;
+        mControlInterval = interval > 0 ? interval : 1;
+    }
+
+    // @brief Runs a single CFR iteration for every player whose strategy is being updated.
+    // @param iteration The index of the iteration, used by the outcome-sampling variant.
+    // @param utils An array receiving the utility of each updated player.
+    template <typename Type>
+    void Trainer<Type>::iterate(const uint64_t iteration, double *utils)
+    {
+        Metrics::ScopedSpan span("iteration", "iteration", int(iteration));
+        for (int p = 0; p < mGame->playerNum(); ++p)
+        {
+            if (!mUpdate[p])
+            {
+                continue;
+            }
+            if (mModeStr == "standard")
+            {
+                mGame->resetGame(false);
+                {
+                    GRASP_PHASE_SCOPE(mPhaseProfile, Metrics::Phase::TRAVERSAL);
+                    Metrics::ScopedSpan span("traversal", "player", p);
+                    utils[p] = CFR(*mGame, p, 1.0, 1.0);
+                }
+                GRASP_PHASE_SCOPE(mPhaseProfile, Metrics::Phase::STRATEGY_UPDATE);
+                Metrics::ScopedSpan span("strategy update");
+                for (auto &itr : mNodeMap)
+                {
+                    itr.second->updateStrategy();
+                }
+            }
+            else
+            {
+                mGame->resetGame();
+                if (mModeStr == "chance")
+                {
                     {
-                        utils[p] = std::get<0>(outcomeSamplingCFR(*mGame, p, i, 1.0, 1.0, 1.0));
+                        GRASP_PHASE_SCOPE(mPhaseProfile, Metrics::Phase::TRAVERSAL);
+                        Metrics::ScopedSpan span("traversal", "player", p);
+                        utils[p] = chanceSamplingCFR(*mGame, p, 1.0, 1.0);
                     }
-                    else
+                    GRASP_PHASE_SCOPE(mPhaseProfile, Metrics::Phase::STRATEGY_UPDATE);
+                    Metrics::ScopedSpan span("strategy update");
+                    for (auto &itr : mNodeMap)
                     {
-                        assert(false);
+                        itr.second->updateStrategy();
                     }
                 }
+                else if (mModeStr == "external")
+                {
+                    GRASP_PHASE_SCOPE(mPhaseProfile, Metrics::Phase::TRAVERSAL);
+                    Metrics::ScopedSpan span("traversal", "player", p);
+                    utils[p] = externalSamplingCFR(*mGame, p);
+                }
+                else if (mModeStr == "outcome")
+                {
+                    GRASP_PHASE_SCOPE(mPhaseProfile, Metrics::Phase::TRAVERSAL);
+                    Metrics::ScopedSpan span("traversal", "player", p);
+                    utils[p] = std::get<0>(outcomeSamplingCFR(*mGame, p, iteration, 1.0, 1.0, 1.0));
+                }
+                else
+                {
+                    assert(false);
+                }
             }
-            if (i % 1000 == 0)
+        }
+        ++mIterationCnt;
+    }
+
+    // @brief Makes later exploitability evaluations reuse the results of the previous one.
+    // @param tolerance The L1 change of an information set's average strategy that triggers a recomputation.
+    template <typename Type>
+    void Trainer<Type>::enableIncrementalExploitability(const double tolerance)
+    {
+        auto game(*mGame);
+        game.resetGame(false);
+        delete mIncremental;
+        mIncremental = new IncrementalExploitability<Type>(game, tolerance);
+    }
+
+    // @brief Calculates the exploitability of the current average strategies of all players.
+    // @return The exploitability value.
+    template <typename Type>
+    double Trainer<Type>::exploitability()
+    {
+        std::unordered_map<std::string, Node *> unvisited;
+        std::vector<std::function<const double *(const Type &)>> strategies(mGame->playerNum());
+        for (int p = 0; p < mGame->playerNum(); ++p)
+        {
+            const std::unordered_map<std::string, Node *> &nodeMap = mUpdate[p] ? mNodeMap : mFixedStrategies[p];
+            strategies[p] = [&nodeMap, &unvisited](const Type &game)
             {
-                std::cout << "iteration:" << i << ", cumulative nodes touched: " << mNodeTouchedCnt << ", infosets num: " << mNodeMap.size() << ", expected payoffs: (";
-                for (int p = 0; p < mGame->playerNum(); ++p)
+                const std::string infoSet = game.infoSetStr();
+                auto itr = nodeMap.find(infoSet);
+                if (itr != nodeMap.end())
                 {
-                    std::cout << utils[p] << ",";
+                    return itr->second->averageStrategy();
                 }
-                std::cout << ")" << std::endl;
+                Node *&node = unvisited[infoSet];
+                if (node == nullptr)
+                {
+                    node = new Node(game.actionNum());
+                }
+                return node->averageStrategy();
+            };
+        }
+
+        auto game(*mGame);
+        game.resetGame(false);
+        Metrics::CounterValues before;
+        if (mEvaluationCounters != nullptr)
+        {
+            before = mEvaluationCounters->read();
+            mEvaluationCounters->start();
+        }
+        double exploitability;
+        if (mIncremental != nullptr)
+        {
+            exploitability = mIncremental->evaluate(strategies);
+            mExploitabilityBytes = mIncremental->memoryBytes();
+        }
+        else
+        {
+            exploitability = CalculateExploitability(game, strategies, &mExploitabilityBytes);
+        }
+        if (mEvaluationCounters != nullptr)
+        {
+            mEvaluationCounters->stop();
+            mLastEvaluationCounters = mEvaluationCounters->read();
+            for (int c = 0; c < (int)Metrics::Counter::NUM; ++c)
+            {
+                mLastEvaluationCounters.value[c] -= before.value[c];
             }
-            if (i != 0 && i % 10000000 == 0)
+        }
+        for (auto &itr : unvisited)
+        {
+            delete itr.second;
+        }
+        mLastExploitability = exploitability;
+        mLastExploitabilityIteration = mIterationCnt;
+        return exploitability;
+    }
+
+#ifdef GRASP_NODE_STATS
+    // @brief Sets the file receiving the per-infoset visit and convergence rankings.
+    // @param path The path of the CSV file; reports are appended to it.
+    // @param topCount The number of information sets listed in each ranking.
+    template <typename Type>
+    void Trainer<Type>::setNodeStatsReport(const std::string &path, const int topCount)
+    {
+        mNodeStatsPath = path;
+        mNodeStatsTop = topCount;
+    }
+
+    // @brief Appends the hottest and least-converged information sets to the node statistics file.
+    // @param iteration The iteration at which the report is written.
+    template <typename Type>
+    void Trainer<Type>::writeNodeStats(const uint64_t iteration)
+    {
+        if (mNodeStatsPath.empty())
+        {
+            return;
+        }
+
+        std::vector<std::tuple<const std::string *, Node *, double>> rows;
+        rows.reserve(mNodeMap.size());
+        for (auto &itr : mNodeMap)
+        {
+            rows.push_back(std::make_tuple(&itr.first, itr.second, itr.second->strategyChange()));
+        }
+
+        const bool writeHeader = !boost::filesystem::exists(mNodeStatsPath) || boost::filesystem::file_size(mNodeStatsPath) == 0;
+        std::ofstream ofs(mNodeStatsPath, std::ios::app);
+        if (writeHeader)
+        {
+            ofs << "iteration,ranking,rank,infoset,visits,regret_updates,strategy_change" << std::endl;
+        }
+        const size_t count = std::min(rows.size(), size_t(mNodeStatsTop));
+        const auto writeRanking = [&](const char *ranking)
+        {
+            for (size_t r = 0; r < count; ++r)
+            {
+                ofs << iteration << "," << ranking << "," << r + 1 << ",";
+                for (char c : *std::get<0>(rows[r]))
+                {
+                    ofs << int(c);
+                }
+                ofs << "," << std::get<1>(rows[r])->visits() << "," << std::get<1>(rows[r])->regretUpdates() << "," << std::get<2>(rows[r]) << "\n";
+            }
+        };
+
+        std::partial_sort(rows.begin(), rows.begin() + count, rows.end(), [](const std::tuple<const std::string *, Node *, double> &lhs, const std::tuple<const std::string *, Node *, double> &rhs)
+                          { return std::get<1>(lhs)->visits() > std::get<1>(rhs)->visits(); });
+        writeRanking("hottest");
+        std::partial_sort(rows.begin(), rows.begin() + count, rows.end(), [](const std::tuple<const std::string *, Node *, double> &lhs, const std::tuple<const std::string *, Node *, double> &rhs)
+                          { return std::get<2>(lhs) > std::get<2>(rhs); });
+        writeRanking("least_converged");
+        ofs.flush();
+
+        for (auto &itr : mNodeMap)
+        {
+            itr.second->markReported();
+        }
+    }
+#endif
+
+    // @brief Accounts the memory held by the node map, the fixed strategies and the exploitability structures.
+    // @return The memory report.
+    template <typename Type>
+    MemoryReport Trainer<Type>::memoryReport() const
+    {
+        MemoryReport report;
+        report.nodeBytes = 0;
+        report.keyBytes = 0;
+        for (auto &itr : mNodeMap)
+        {
+            report.nodeBytes += itr.second->memoryBytes();
+            report.keyBytes += KeyBytes(itr.first);
+        }
+        report.hashTableBytes = HashTableBytes(mNodeMap);
+
+        report.fixedStrategyBytes = 0;
+        for (int p = 0; p < mGame->playerNum(); ++p)
+        {
+            report.fixedStrategyBytes += HashTableBytes(mFixedStrategies[p]);
+            for (auto &itr : mFixedStrategies[p])
             {
-                writeStrategyToBin(i);
+                report.fixedStrategyBytes += KeyBytes(itr.first) + itr.second->memoryBytes();
             }
         }
+        report.exploitabilityBytes = mExploitabilityBytes;
+
+        report.entries = mNodeMap.size();
+        report.bucketCount = mNodeMap.bucket_count();
+        report.loadFactor = mNodeMap.load_factor();
+        report.maxLoadFactor = mNodeMap.max_load_factor();
+        report.emptyBuckets = 0;
+        report.maxBucketLength = 0;
+        for (size_t b = 0; b < mNodeMap.bucket_count(); ++b)
+        {
+            const uint64_t length = mNodeMap.bucket_size(b);
+            report.emptyBuckets += length == 0 ? 1 : 0;
+            report.maxBucketLength = std::max(report.maxBucketLength, length);
+        }
+        const uint64_t usedBuckets = report.bucketCount - report.emptyBuckets;
+        report.meanBucketLength = usedBuckets > 0 ? double(report.entries) / double(usedBuckets) : 0.0;
+        return report;
+    }
+
+    // @brief Starts counting hardware events during training iterations and exploitability evaluations.
+    // @return True if at least one hardware counter is available.
+    template <typename Type>
+    bool Trainer<Type>::enablePerfCounters()
+    {
+        if (mIterationCounters == nullptr)
+        {
+            mIterationCounters = new Metrics::PerfCounters();
+            mEvaluationCounters = new Metrics::PerfCounters();
+        }
+        return mIterationCounters->available();
+    }
 
-        writeStrategyToBin();
+    // @brief Returns the wall time accumulated per training phase.
+    // @return A reference to the phase profile.
+    template <typename Type>
+    const Metrics::PhaseProfile &Trainer<Type>::phaseProfile() const
+    {
+        return mPhaseProfile;
+    }
+
+    // @brief Returns the exploitability upper bound implied by the cumulative counterfactual regrets.
+    // @param iterations The number of iterations completed.
+    // @return The exploitability upper bound.
+    template <typename Type>
+    double Trainer<Type>::regretBound(const uint64_t iterations) const
+    {
+        if (iterations == 0)
+        {
+            return 0.0;
+        }
+        double regret = 0.0;
+        for (const double r : mPositiveRegret)
+        {
+            // the running sums may drift slightly below zero through rounding
+            regret += std::max(r, 0.0);
+        }
+        return regret / double(iterations);
+    }
+
+    // @brief Returns the number of nodes touched since the trainer was constructed.
+    // @return The cumulative number of nodes touched.
+    template <typename Type>
+    uint64_t Trainer<Type>::nodeTouchedCount() const
+    {
+        return mNodeTouchedCnt;
+    }
+
+    // @brief Returns the map of information sets to the nodes being trained.
+    // @return A reference to the node map.
+    template <typename Type>
+    const std::unordered_map<std::string, Node *> &Trainer<Type>::nodeMap() const
+    {
+        return mNodeMap;
     }
 
     // @brief Performs the standard CFR algorithm.
@@ -424,9 +1042,11 @@ namespace Trainer
         Node *node = mNodeMap[infoSet];
         if (node == nullptr)
         {
+            GRASP_PHASE_SCOPE(mPhaseProfile, Metrics::Phase::NODE_CREATION);
             node = new Node(actionNum);
             mNodeMap[infoSet] = node;
         }
+        GRASP_NODE_VISIT(node, player == playerIndex);
 
         const double *strategy = node->strategy();
 
@@ -450,12 +1070,14 @@ namespace Trainer
         if (player == playerIndex)
         {
 
+            const double positiveRegret = node->positiveRegret();
             for (int a = 0; a < actionNum; ++a)
             {
                 const double regret = utils[a] - nodeUtil;
                 const double regretSum = node->regretSum(a) + po * regret;
                 node->regretSum(a, regretSum);
             }
+            mPositiveRegret[player] += node->positiveRegret() - positiveRegret;
 
             node->strategySum(strategy, pi);
         }
@@ -487,17 +1109,18 @@ namespace Trainer
         {
             auto game_cp(game);
             auto strategy = mFixedStrategies[player].at(infoSet)->averageStrategy();
-            std::discrete_distribution<int> dist(strategy, strategy + actionNum);
-            game_cp.takeAction(dist(randomGenerator));
+            game_cp.takeAction(sampleAction(strategy, actionNum));
             return chanceSamplingCFR(game_cp, playerIndex, pi, po);
         }
 
         Node *node = mNodeMap[infoSet];
         if (node == nullptr)
         {
+            GRASP_PHASE_SCOPE(mPhaseProfile, Metrics::Phase::NODE_CREATION);
             node = new Node(actionNum);
             mNodeMap[infoSet] = node;
         }
+        GRASP_NODE_VISIT(node, player == playerIndex);
 
         const double *strategy = node->strategy();
 
@@ -521,12 +1144,14 @@ namespace Trainer
         if (player == playerIndex)
         {
 
+            const double positiveRegret = node->positiveRegret();
             for (int a = 0; a < actionNum; ++a)
             {
                 const double regret = utils[a] - nodeUtil;
                 const double regretSum = node->regretSum(a) + po * regret;
                 node->regretSum(a, regretSum);
             }
+            mPositiveRegret[player] += node->positiveRegret() - positiveRegret;
 
             node->strategySum(strategy, pi);
         }
@@ -557,9 +1182,11 @@ namespace Trainer
         Node *node = mNodeMap[infoSet];
         if (node == nullptr)
         {
+            GRASP_PHASE_SCOPE(mPhaseProfile, Metrics::Phase::NODE_CREATION);
             node = new Node(actionNum);
             mNodeMap[infoSet] = node;
         }
+        GRASP_NODE_VISIT(node, player == playerIndex);
 
         node->updateStrategy();
         const double *strategy = node->strategy();
@@ -567,8 +1194,7 @@ namespace Trainer
         if (player != playerIndex)
         {
             auto game_cp(game);
-            std::discrete_distribution<int> dist(strategy, strategy + actionNum);
-            game_cp.takeAction(dist(randomGenerator));
+            game_cp.takeAction(sampleAction(strategy, actionNum));
             const double util = externalSamplingCFR(game_cp, playerIndex);
 
             node->strategySum(strategy, 1.0);
@@ -585,12 +1211,14 @@ namespace Trainer
             nodeUtil += strategy[a] * utils[a];
         }
 
+        const double positiveRegret = node->positiveRegret();
         for (int a = 0; a < actionNum; ++a)
         {
             const double regret = utils[a] - nodeUtil;
             const double regretSum = node->regretSum(a) + regret;
             node->regretSum(a, regretSum);
         }
+        mPositiveRegret[player] += node->positiveRegret() - positiveRegret;
 
         return nodeUtil;
     }
@@ -604,7 +1232,7 @@ namespace Trainer
     // @param s A scaling factor used in the sampling process.
     // @return A tuple containing the utility value and a probability factor.
     template <typename Type>
-    std::tuple<double, double> Trainer<Type>::outcomeSamplingCFR(const Type &game, const int playerIndex, const int iteration, const double pi, const double po, const double s)
+    std::tuple<double, double> Trainer<Type>::outcomeSamplingCFR(const Type &game, const int playerIndex, const uint64_t iteration, const double pi, const double po, const double s)
     {
         ++mNodeTouchedCnt;
 
@@ -622,9 +1250,11 @@ namespace Trainer
         Node *node = mNodeMap[infoSet];
         if (node == nullptr)
         {
+            GRASP_PHASE_SCOPE(mPhaseProfile, Metrics::Phase::NODE_CREATION);
             node = new Node(actionNum);
             mNodeMap[infoSet] = node;
         }
+        GRASP_NODE_VISIT(node, player == playerIndex);
 
         node->updateStrategy();
         const double *strategy = node->strategy();
@@ -645,8 +1275,7 @@ namespace Trainer
                 probability[a] = strategy[a];
             }
         }
-        std::discrete_distribution<int> dist(probability, probability + actionNum);
-        const int chooseAction = dist(randomGenerator);
+        const int chooseAction = sampleAction(probability, actionNum);
 
         double util, pTail;
         auto game_cp(game);
@@ -660,12 +1289,14 @@ namespace Trainer
         {
 
             const double W = util * po;
+            const double positiveRegret = node->positiveRegret();
             for (int a = 0; a < actionNum; ++a)
             {
                 const double regret = a == chooseAction ? W * (1.0 - strategy[chooseAction]) * pTail : -W * pTail * strategy[chooseAction];
                 const double regretSum = node->regretSum(a) + regret;
                 node->regretSum(a, regretSum);
             }
+            mPositiveRegret[player] += node->positiveRegret() - positiveRegret;
         }
         else
         {
@@ -675,11 +1306,99 @@ namespace Trainer
         return std::make_tuple(util, pTail * strategy[chooseAction]);
     }
 
+    // @brief Samples an action from a probability distribution without allocating.
+    // @param probability The probability of each action; it does not need to be normalized.
+    // @param actionNum The number of actions.
+    // @return The index of the sampled action.
+    template <typename Type>
+    int Trainer<Type>::sampleAction(const double *probability, const int actionNum)
+    {
+        double total = 0.0;
+        for (int a = 0; a < actionNum; ++a)
+        {
+            total += probability[a];
+        }
+        const double r = std::uniform_real_distribution<double>(0.0, total)(randomGenerator);
+        double cumulative = 0.0;
+        int last = 0;
+        for (int a = 0; a < actionNum; ++a)
+        {
+            if (probability[a] <= 0.0)
+            {
+                continue;
+            }
+            cumulative += probability[a];
+            last = a;
+            if (r < cumulative)
+            {
+                return a;
+            }
+        }
+        return last;
+    }
+
+    // @brief Writes a progress record to the metrics sink.
+    // @param iteration The index of the iteration that has just completed.
+    // @param utils The utility of each player in that iteration.
+    template <typename Type>
+    void Trainer<Type>::writeMetrics(const uint64_t iteration, const double *utils)
+    {
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - mTrainStart).count();
+#ifdef GRASP_COUNT_ALLOCATIONS
+        const uint64_t allocationCount = Metrics::allocationStats().count;
+#endif
+        Metrics::Record record;
+        record.iteration = iteration;
+        record.wallSeconds = seconds;
+        record.nodesTouched = mNodeTouchedCnt;
+        record.nodesPerSecond = seconds > mLastMetricsSeconds ? double(mNodeTouchedCnt - mLastMetricsNodes) / (seconds - mLastMetricsSeconds) : 0.0;
+        record.infoSetNum = mNodeMap.size();
+        record.memoryBytes = Metrics::residentMemoryBytes();
+        record.utils.assign(utils, utils + mGame->playerNum());
+        record.extra.emplace_back("regret_bound", regretBound(mIterationCnt));
+        if (mIterationCounters != nullptr)
+        {
+            mIterationCounters->stop();
+            const Metrics::CounterValues counters = mIterationCounters->read();
+            const double nodes = double(mNodeTouchedCnt - mLastMetricsNodes);
+            for (int c = 0; c < (int)Metrics::Counter::NUM; ++c)
+            {
+                if (counters.valid[c])
+                {
+                    const double delta = double(counters.value[c] - mLastIterationCounters.value[c]);
+                    record.extra.emplace_back(std::string(Metrics::CounterName(Metrics::Counter(c))) + "_per_mnode", nodes > 0 ? delta * 1e6 / nodes : 0.0);
+                    // the evaluation columns are present from the first record on, so that the CSV header stays fixed;
+                    // they read 0 until an evaluation has been counted
+                    record.extra.emplace_back(std::string("eval_") + Metrics::CounterName(Metrics::Counter(c)), double(mLastEvaluationCounters.value[c]));
+                }
+            }
+            mLastIterationCounters = counters;
+        }
+#ifdef GRASP_COUNT_ALLOCATIONS
+        const uint64_t iterationDelta = iteration + 1 - mLastMetricsIteration;
+        record.extra.emplace_back("allocs_per_iteration", double(allocationCount - mLastAllocationCount) / double(iterationDelta));
+#endif
+        mMetricsSink->write(record);
+        mLastMetricsSeconds = seconds;
+        mLastMetricsNodes = mNodeTouchedCnt;
+        mLastMetricsIteration = iteration + 1;
+#ifdef GRASP_COUNT_ALLOCATIONS
+        // allocations made while formatting this record are not charged to the next interval
+        mLastAllocationCount = Metrics::allocationStats().count;
+#endif
+        if (mIterationCounters != nullptr)
+        {
+            mIterationCounters->start();
+        }
+    }
+
     // @brief Writes the current strategies to a binary file.
-    // @param iteration The iteration number to include in the file name (optional).
+    // @param iteration The iteration number to include in the file name, or 0 for the final strategy.
     template <typename Type>
-    void Trainer<Type>::writeStrategyToBin(const int iteration) const
+    void Trainer<Type>::writeStrategyToBin(const uint64_t iteration)
     {
+        GRASP_PHASE_SCOPE(mPhaseProfile, Metrics::Phase::CHECKPOINT);
+        Metrics::ScopedSpan span("checkpoint");
         for (auto &itr : mNodeMap)
         {
             for (char c : itr.first)
@@ -696,10 +1415,18 @@ namespace Trainer
         std::string path = iteration > 0 ? "strategy_" + std::to_string(iteration)
                                          : "strategy";
         path += "_" + mModeStr + ".bin";
+        if (mControlServer != nullptr)
+        {
+            publishStatus("checkpointing");
+        }
         std::ofstream ofs(mFolderPath + "/" + path);
         boost::archive::binary_oarchive oa(ofs);
         oa << mNodeMap;
         ofs.close();
+        ++mCheckpointCnt;
+        mLastCheckpointIteration = mIterationCnt;
+        mLastCheckpointPath = mFolderPath + "/" + path;
+        memoryReport().write(std::cerr);
     }
 
 }
\ No newline at end of file
@@ -1,12 +1,28 @@
 #ifndef GRASP_TRAINER_HPP
 #define GRASP_TRAINER_HPP
 
+#include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <future>
+#include <mutex>
 #include <random>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
+#include "IncrementalExploitability.hpp"
+#include "MemoryReport.hpp"
+#include "PerfCounters.hpp"
+#include "PhaseTimer.hpp"
+#include "StoppingCriteria.hpp"
+
+namespace Metrics
+{
+    class ControlServer;
+    class MetricsSink;
+}
 
 namespace Trainer
 {
@@ -42,8 +58,9 @@ namespace Trainer
         // @brief Calculates the exploitability of the current strategies in the game.
         // @param game The current state of the game.
         // @param strategies A vector of functions that return the strategy for each player.
+        // @param tableBytes If not nullptr, receives the memory used by the information set and best-response tables.
         // @return The exploitability value.
-        static double CalculateExploitability(const Type &game, const std::vector<std::function<const double *(const Type &)>> &strategies);
+        static double CalculateExploitability(const Type &game, const std::vector<std::function<const double *(const Type &)>> &strategies, uint64_t *tableBytes = nullptr);
 
         // @brief Creates information sets for the game from the perspective of a specific player.
         // @param game The current state of the game.
@@ -64,8 +81,83 @@ namespace Trainer
         static double CalculateBestResponseValue(const Type &game, int playerIndex, const std::vector<std::function<const double *(const Type &)>> &strategies, std::unordered_map<std::string, std::vector<double>> &bestResponseStrategies, double po, const InfoSets &infoSets);
 
         // @brief Trains the strategies using CFR for a specified number of iterations.
+        // @details Unlike StoppingCriteria::maxIterations, 0 does not mean "no limit": the call returns at once, without
+        //          training or writing the final strategy.
         // @param iterations The number of iterations to run the CFR algorithm.
-        void train(int iterations);
+        void train(uint64_t iterations);
+
+        // @brief Trains the strategies using CFR until one of the stopping criteria holds.
+        // @details Training also stops when the control endpoint requests it. An unbounded criteria set only ends on
+        //          such a request.
+        // @param criteria The stopping criteria.
+        // @return The condition that ended training.
+        StopReason train(const StoppingCriteria &criteria);
+
+        // @brief Sets the sink receiving training progress records.
+        // @param sink The sink to write to, or nullptr to disable progress records. The trainer does not take ownership.
+        // @param interval The number of iterations between two records.
+        void setMetricsSink(Metrics::MetricsSink *sink, uint64_t interval);
+
+        // @brief Attaches the local control endpoint.
+        // @details The trainer publishes its status to the server and honours its checkpoint and stop requests.
+        // @param server The server, or nullptr to detach it. The trainer does not take ownership.
+        // @param interval The number of iterations between two status updates.
+        void setControlServer(Metrics::ControlServer *server, uint64_t interval);
+
+#ifdef GRASP_NODE_STATS
+        // @brief Sets the file receiving the per-infoset visit and convergence rankings.
+        // @details A report is appended at every checkpoint, at the end of training and on SIGUSR1.
+        // @param path The path of the CSV file; reports are appended to it.
+        // @param topCount The number of information sets listed in each ranking.
+        void setNodeStatsReport(const std::string &path, int topCount);
+#endif
+
+        // @brief Accounts the memory held by the node map, the fixed strategies and the exploitability structures.
+        // @return The memory report.
+        MemoryReport memoryReport() const;
+
+        // @brief Starts counting hardware events during training iterations and exploitability evaluations.
+        // @details Must be called from the thread that trains. The counts are added to the progress records, per
+        //          million nodes touched for training and per evaluation for exploitability.
+        // @return True if at least one hardware counter is available.
+        bool enablePerfCounters();
+
+        // @brief Returns the wall time accumulated per training phase.
+        // @details The profile is only filled when the build defines GRASP_PHASE_TIMING.
+        // @return A reference to the phase profile.
+        const Metrics::PhaseProfile &phaseProfile() const;
+
+        // @brief Runs a single CFR iteration for every player whose strategy is being updated.
+        // @param iteration The index of the iteration, used by the outcome-sampling variant.
+        // @param utils An array receiving the utility of each updated player.
+        void iterate(uint64_t iteration, double *utils);
+
+        // @brief Makes later exploitability evaluations reuse the results of the previous one.
+        // @details The game tree is expanded once; each evaluation then only recomputes the subtrees below information
+        //          sets whose average strategy moved by more than the tolerance since they were last refreshed.
+        // @param tolerance The L1 change of an information set's average strategy that triggers a recomputation.
+        void enableIncrementalExploitability(double tolerance);
+
+        // @brief Calculates the exploitability of the current average strategies of all players.
+        // @details Information sets that have not been visited yet are evaluated with a uniform strategy.
+        // @return The exploitability value.
+        double exploitability();
+
+        // @brief Returns the exploitability upper bound implied by the cumulative counterfactual regrets.
+        // @details The bound is the sum over players and information sets of the largest positive cumulative regret,
+        //          divided by the number of iterations. It is maintained as the regrets change, so reading it is free.
+        //          For the sampling variants the regrets, and hence the bound, are estimates.
+        // @param iterations The number of iterations completed.
+        // @return The exploitability upper bound.
+        double regretBound(uint64_t iterations) const;
+
+        // @brief Returns the number of nodes touched since the trainer was constructed.
+        // @return The cumulative number of nodes touched.
+        uint64_t nodeTouchedCount() const;
+
+        // @brief Returns the map of information sets to the nodes being trained.
+        // @return A reference to the node map.
+        const std::unordered_map<std::string, Node *> &nodeMap() const;
 
     private:
         // @brief Performs the standard CFR algorithm.
@@ -98,20 +190,96 @@ namespace Trainer
         // @param po The product of the probabilities of actions taken by all players.
         // @param s A scaling factor used in the sampling process.
         // @return A tuple containing the utility value and a probability factor.
-        std::tuple<double, double> outcomeSamplingCFR(const Type &game, int playerIndex, int iteration, double pi, double po, double s);
+        std::tuple<double, double> outcomeSamplingCFR(const Type &game, int playerIndex, uint64_t iteration, double pi, double po, double s);
+
+        // @brief Calculates the payoff for each player in a given game state into a caller-provided array.
+        // @param game The current state of the game.
+        // @param strategies A vector of functions that return the strategy for each player.
+        // @param payoffs An array receiving the payoff of each player.
+        static void CalculatePayoff(const Type &game, const std::vector<std::function<const double *(const Type &)>> &strategies, double *payoffs);
+
+        // @brief Samples an action from a probability distribution without allocating.
+        // @param probability The probability of each action; it does not need to be normalized.
+        // @param actionNum The number of actions.
+        // @return The index of the sampled action.
+        int sampleAction(const double *probability, int actionNum);
+
+        // @brief Writes a progress record to the metrics sink.
+        // @param iteration The index of the iteration that has just completed.
+        // @param utils The utility of each player in that iteration.
+        void writeMetrics(uint64_t iteration, const double *utils);
+
+#ifdef GRASP_NODE_STATS
+        // @brief Appends the hottest and least-converged information sets to the node statistics file.
+        // @param iteration The iteration at which the report is written.
+        void writeNodeStats(uint64_t iteration);
+#endif
+
+        // @brief Collects the result of the background exploitability evaluation and starts the next one when due.
+        // @param interval The minimum number of iterations between two evaluations.
+        // @return True if an evaluation has completed since the last call.
+        bool pollExploitability(uint64_t interval);
+
+        // @brief Body of the thread running the background exploitability evaluations one at a time.
+        void runEvaluations();
+
+        // @brief Writes a checkpoint of the current strategies, pausing the iteration counters meanwhile.
+        // @param iteration The iteration at which the checkpoint is written.
+        void checkpoint(uint64_t iteration);
+
+        // @brief Publishes the current status to the control server.
+        // @param state The training state.
+        void publishStatus(const char *state);
 
         // @brief Writes the current strategies to a binary file.
-        // @param iteration The iteration number to include in the file name (optional).
-        void writeStrategyToBin(int iteration = -1) const;
+        // @param iteration The iteration number to include in the file name, or 0 for the final strategy.
+        void writeStrategyToBin(uint64_t iteration = 0);
 
         std::mt19937 randomGenerator;                              // Random number generator for sampling actions.
         std::unordered_map<std::string, Node *> mNodeMap;          // Map of information sets to nodes containing strategies and regrets.
         uint64_t mNodeTouchedCnt;                                  // Counter for the number of nodes touched during training.
         Type *mGame;                                               // Pointer to the game being trained.
         std::string mFolderPath;                                   // Path to the folder where strategies are saved.
-        const std::string &mModeStr;                               // Mode string indicating the variant of CFR being used.
+        const std::string mModeStr;                                // Mode string indicating the variant of CFR being used.
         std::unordered_map<std::string, Node *> *mFixedStrategies; // Array of maps for fixed strategies, one for each player.
         bool *mUpdate;                                             // Array indicating which players' strategies are being updated.
+        std::vector<double> mPositiveRegret;                       // Sum of the largest positive cumulative regret of every information set, per player.
+        Metrics::MetricsSink *mMetricsSink;                        // Sink receiving progress records, or nullptr.
+        uint64_t mMetricsInterval;                                 // Number of iterations between two progress records.
+        std::chrono::steady_clock::time_point mTrainStart;         // Time at which train() started.
+        Metrics::PhaseProfile mPhaseProfile;                       // Wall time accumulated per training phase.
+        Metrics::PerfCounters *mIterationCounters;                 // Hardware counters of training iterations, or nullptr.
+        Metrics::PerfCounters *mEvaluationCounters;                // Hardware counters of exploitability evaluations, or nullptr.
+        Metrics::CounterValues mLastIterationCounters;             // Iteration counter values at the previous progress record.
+        Metrics::CounterValues mLastEvaluationCounters;            // Counter values of the last exploitability evaluation.
+        Metrics::CounterValues mBackgroundCounters;                // Counter values of the last background evaluation, written by its thread.
+        uint64_t mLastMetricsIteration;                            // Iteration of the previous progress record.
+        uint64_t mLastAllocationCount;                             // Heap allocations counted at the previous progress record.
+        IncrementalExploitability<Type> *mIncremental;             // Incremental exploitability evaluator, or nullptr.
+        Metrics::ControlServer *mControlServer;                    // Local control endpoint, or nullptr.
+        uint64_t mControlInterval;                                 // Number of iterations between two status updates.
+        uint64_t mIterationCnt;                                    // Number of iterations run since the trainer was constructed.
+        uint64_t mTargetIterations;                                // Value of mIterationCnt at which the current train() call ends.
+        double mLastExploitability;                                // Result of the last exploitability evaluation, or NaN.
+        uint64_t mLastExploitabilityIteration;                     // Iterations completed at the last exploitability evaluation.
+        std::future<double> mPendingExploitability;                // Background exploitability evaluation, if any.
+        uint64_t mPendingExploitabilityIteration;                  // Iterations completed at the snapshot being evaluated.
+        std::thread mEvaluationThread;                             // Thread running the background evaluations, started by the first one.
+        std::mutex mEvaluationMutex;                               // Mutex guarding the queued evaluation and the stop flag.
+        std::condition_variable mEvaluationCondition;              // Condition signalled when an evaluation is queued or the thread should exit.
+        std::function<double()> mEvaluationTask;                   // Evaluation waiting for the thread, or empty.
+        std::promise<double> mEvaluationPromise;                   // Promise receiving the result of the queued evaluation.
+        bool mEvaluationStop;                                      // Flag asking the evaluation thread to exit.
+        uint64_t mCheckpointCnt;                                   // Number of checkpoints written.
+        uint64_t mLastCheckpointIteration;                         // Iterations completed at the last checkpoint.
+        std::string mLastCheckpointPath;                           // Path of the last checkpoint, or empty.
+        uint64_t mExploitabilityBytes;                             // Memory used by the tables of the last exploitability evaluation.
+#ifdef GRASP_NODE_STATS
+        std::string mNodeStatsPath;                                // Path of the node statistics file, or empty.
+        int mNodeStatsTop;                                         // Number of information sets listed in each ranking.
+#endif
+        double mLastMetricsSeconds;                                // Wall time of the previous progress record.
+        uint64_t mLastMetricsNodes;                                // Nodes touched at the previous progress record.
     };
 
 }
@@ -1,7 +1,14 @@
+#include <iostream>
+#include <memory>
 #include <random>
+#include <stdexcept>
 #include <string>
 #include "cmdline.h"
+#include "ControlServer.hpp"
 #include "Game.hpp"
+#include "MetricsSink.hpp"
+#include "Signal.hpp"
+#include "Tracer.hpp"
 #include "Trainer.hpp"
 #include "Trainer.cpp"
 
@@ -17,19 +24,114 @@ int main(int argc, char *argv[])
                        false, "standard",
                        cmdline::oneof<std::string>("standard", "chance", "external", "outcome"));
 
-    // Add a command-line argument to specify the number of iterations for CFR
-    p.add<uint64_t>("iteration", 'i', "Number of iterations of CFR", true);
+    // Add command-line arguments specifying when training stops; the first condition met ends it
+    p.add<uint64_t>("iteration", 'i', "Number of iterations of CFR, 0 for no limit", false, 0);
+    p.add<double>("max-time", 0, "Wall-clock budget in seconds, 0 for no limit", false, 0.0);
+    p.add<double>("target-exploitability", 0, "Stop once a background evaluation measures this exploitability or less, 0 to disable", false, 0.0);
+    p.add<uint64_t>("exploitability-interval", 0, "Minimum number of iterations between two background exploitability evaluations", false, 1000);
+    p.add("incremental-exploitability", 0, "Evaluate exploitability incrementally, recomputing only subtrees whose strategy changed");
+    p.add<double>("exploitability-tolerance", 0, "L1 strategy change of an information set that triggers its recomputation in incremental evaluations", false, 0.0);
+    p.add<double>("target-regret-bound", 0, "Stop once the regret-based exploitability bound falls to this value or less, 0 to disable", false, 0.0);
 
     // Add a command-line argument to specify the random seed for initialization
     p.add<uint32_t>("seed", 's', "Random seed used to initialize the random generator", false);
 
+    // Add command-line arguments controlling the training progress records
+    p.add<std::string>("metrics-format", 0, "Format of the progress records (default \"jsonl\")",
+                       false, "jsonl", cmdline::oneof<std::string>("jsonl", "csv"));
+    p.add<std::string>("metrics-path", 0, "Path of the file receiving progress records (default: standard output)", false, "");
+    p.add<uint64_t>("metrics-interval", 0, "Number of iterations between two progress records, 0 to disable them", false, 1000);
+
+    // Add a command-line flag enabling hardware performance counters in the progress records
+    p.add("perf-counters", 0, "Report cycles, instructions, cache and branch misses per million nodes touched");
+
+    // Add a command-line argument enabling the Chrome trace export
+    p.add<std::string>("trace-path", 0, "Path of a Chrome trace JSON file recording iterations, traversals, sweeps and checkpoints", false, "");
+
+    // Add command-line arguments enabling the local control endpoint
+    p.add<std::string>("control", 0, "Unix socket path, or loopback TCP port, serving GET /status, POST /checkpoint and POST /stop", false, "");
+    p.add<uint64_t>("control-interval", 0, "Number of iterations between two status updates of the control endpoint", false, 1000);
+
+#ifdef GRASP_NODE_STATS
+    // Add command-line arguments controlling the per-infoset statistics report
+    p.add<std::string>("node-stats-path", 0, "Path of a CSV file receiving the hottest and least-converged information sets", false, "");
+    p.add<int>("node-stats-top", 0, "Number of information sets listed in each ranking", false, 20);
+#endif
+
     // Parse and check the command-line arguments
     p.parse_check(argc, argv);
+    Trainer::StoppingCriteria criteria;
+    criteria.maxIterations = p.get<uint64_t>("iteration");
+    criteria.maxSeconds = p.get<double>("max-time");
+    criteria.targetExploitability = p.get<double>("target-exploitability");
+    criteria.exploitabilityInterval = p.get<uint64_t>("exploitability-interval");
+    criteria.targetRegretBound = p.get<double>("target-regret-bound");
+    if (!criteria.bounded() && p.get<std::string>("control").empty())
+    {
+        std::cerr << "no stopping criterion: set --iteration, --max-time, --target-exploitability or --target-regret-bound" << std::endl;
+        return 1;
+    }
 
     // Initialize the trainer with the specified algorithm and seed
     Trainer::Trainer<Kuhn::Game> trainer(p.get<std::string>("algorithm"),
                                          p.exist("seed") ? p.get<uint32_t>("seed") : std::random_device()());
 
-    // Run the training for the specified number of iterations
-    trainer.train(int(p.get<uint64_t>("iteration")));
+    // Attach the progress record sink
+    Metrics::MetricsSink sink(Metrics::MetricsSink::ParseFormat(p.get<std::string>("metrics-format")), p.get<std::string>("metrics-path"));
+    if (p.get<uint64_t>("metrics-interval") > 0)
+    {
+        trainer.setMetricsSink(&sink, p.get<uint64_t>("metrics-interval"));
+    }
+
+    // Serve the training status and accept checkpoint and stop requests
+    std::unique_ptr<Metrics::ControlServer> controlServer;
+    if (!p.get<std::string>("control").empty())
+    {
+        try
+        {
+            controlServer.reset(new Metrics::ControlServer(p.get<std::string>("control")));
+        }
+        catch (const std::runtime_error &e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        trainer.setControlServer(controlServer.get(), p.get<uint64_t>("control-interval"));
+    }
+
+#ifdef GRASP_NODE_STATS
+    // Report the per-infoset statistics at checkpoints
+    trainer.setNodeStatsReport(p.get<std::string>("node-stats-path"), p.get<int>("node-stats-top"));
+#endif
+
+    // Reuse unchanged subtrees between exploitability evaluations
+    if (p.exist("incremental-exploitability"))
+    {
+        trainer.enableIncrementalExploitability(p.get<double>("exploitability-tolerance"));
+    }
+
+    // Open the hardware performance counters on the training thread
+    if (p.exist("perf-counters") && !trainer.enablePerfCounters())
+    {
+        std::cerr << "hardware performance counters are not available" << std::endl;
+    }
+
+    // Print the memory report and the phase timing summary on SIGUSR1
+    Metrics::installReportHandler();
+
+    // Start recording spans before the first iteration
+    if (!p.get<std::string>("trace-path").empty())
+    {
+        Metrics::Tracer::Enable();
+    }
+
+    // Run the training until a stopping criterion holds
+    trainer.train(criteria);
+
+    // Export the recorded spans
+    if (!p.get<std::string>("trace-path").empty() && !Metrics::Tracer::Export(p.get<std::string>("trace-path")))
+    {
+        std::cerr << "cannot write trace \"" << p.get<std::string>("trace-path") << "\"" << std::endl;
+        return 1;
+    }
 }
\ No newline at end of file
@@ -60,7 +60,7 @@ namespace Kuhn
 
         for (int c1 = int(playerCards.size()) - 1; c1 > 0; --c1)
         {
-            const int c2 = int(randomGenerator()) % (c1 + 1);
+            const int c2 = int(randomGenerator() % (c1 + 1));
             const int tmp = playerCards[c1];
             playerCards[c1] = playerCards[c2];
             playerCards[c2] = tmp;
@@ -0,0 +1,328 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/serialization/unordered_map.hpp>
+#include "cmdline.h"
+#include "Game.hpp"
+#include "Node.hpp"
+#include "Trainer.hpp"
+#include "Trainer.cpp"
+
+// defines the game
+#define GAME Kuhn::Game
+
+// Average strategies of a checkpoint, keyed by information set.
+typedef std::unordered_map<std::string, Trainer::Node *> StrategyMap;
+
+// @brief A strategy file written by Trainer::writeStrategyToBin and the results of its evaluation.
+struct Checkpoint
+{
+    std::string path;      // Path of the strategy file.
+    std::string mode;      // CFR variant that produced the file.
+    uint64_t iteration;    // Iteration at which the file was written.
+    bool isFinal;          // Flag indicating if this is the strategy written at the end of training.
+    StrategyMap *strategy; // Loaded strategy, owned by the checkpoint, or nullptr if the file cannot be loaded.
+    std::string loadError; // Reason the file cannot be loaded, or empty.
+    double loadSeconds;    // Time spent deserializing the file.
+    double evalSeconds;    // Time spent evaluating the strategy.
+    double exploitability; // Exploitability of the strategy.
+    double selfEV;         // Expected payoff of player 0 when every seat plays the strategy.
+    double crossEV;        // Expected payoff against the reference strategy, averaged over seats.
+};
+
+// @brief Parses the name of a strategy file ("strategy_<iteration>_<mode>.bin" or "strategy_<mode>.bin").
+// @param name The file name.
+// @param checkpoint The checkpoint receiving the mode and iteration.
+// @return True if the name is the name of a strategy file.
+static bool parseName(const std::string &name, Checkpoint &checkpoint)
+{
+    const std::string prefix = "strategy_", suffix = ".bin";
+    if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0)
+    {
+        return false;
+    }
+    const std::string stem = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+    const size_t separator = stem.find('_');
+    if (separator == std::string::npos)
+    {
+        checkpoint.mode = stem;
+        checkpoint.iteration = 0;
+        checkpoint.isFinal = true;
+        return true;
+    }
+    const std::string iteration = stem.substr(0, separator);
+    if (iteration.empty() || iteration.find_first_not_of("0123456789") != std::string::npos)
+    {
+        return false;
+    }
+    checkpoint.mode = stem.substr(separator + 1);
+    checkpoint.iteration = std::stoull(iteration);
+    checkpoint.isFinal = false;
+    return true;
+}
+
+// @brief Loads a strategy file.
+// @param path The path of the strategy file.
+// @return The loaded strategy; the caller takes ownership. Throws std::exception if the file cannot be read.
+static StrategyMap *loadStrategy(const std::string &path)
+{
+    StrategyMap *strategy = new StrategyMap();
+    try
+    {
+        std::ifstream ifs(path, std::ios::binary);
+        boost::archive::binary_iarchive ia(ifs);
+        ia >> *strategy;
+    }
+    catch (...)
+    {
+        // a truncated file may fail after some nodes have been read
+        for (auto &itr : *strategy)
+        {
+            delete itr.second;
+        }
+        delete strategy;
+        throw;
+    }
+    return strategy;
+}
+
+// @brief Deletes a loaded strategy and its nodes.
+// @param strategy The strategy to delete.
+static void deleteStrategy(StrategyMap *strategy)
+{
+    for (auto &itr : *strategy)
+    {
+        delete itr.second;
+    }
+    delete strategy;
+}
+
+// @brief Returns a strategy function reading a loaded strategy, with a uniform fallback for missing information sets.
+// @param strategy The loaded strategy. Its average strategies are computed on load, so concurrent reads are safe.
+// @param uniform Uniform strategies indexed by action count.
+// @return The strategy function.
+static std::function<const double *(const GAME &)> strategyFunction(const StrategyMap &strategy, const std::vector<std::vector<double>> &uniform)
+{
+    return [&strategy, &uniform](const GAME &game)
+    {
+        auto itr = strategy.find(game.infoSetStr());
+        if (itr != strategy.end())
+        {
+            return itr->second->averageStrategy();
+        }
+        return uniform[game.actionNum()].data();
+    };
+}
+
+// @brief Evaluates a checkpoint.
+// @param checkpoint The checkpoint, whose strategy is loaded.
+// @param reference The reference strategy of the cross-EV, or nullptr.
+// @param root The initial state of the game.
+// @param uniform Uniform strategies indexed by action count.
+static void evaluate(Checkpoint &checkpoint, const StrategyMap *reference, const GAME &root, const std::vector<std::vector<double>> &uniform)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::function<const double *(const GAME &)>> strategies(GAME::playerNum(), strategyFunction(*checkpoint.strategy, uniform));
+    checkpoint.exploitability = Trainer::Trainer<GAME>::CalculateExploitability(root, strategies);
+    checkpoint.selfEV = Trainer::Trainer<GAME>::CalculatePayoff(root, strategies)[0];
+
+    checkpoint.crossEV = 0.0;
+    if (reference != nullptr)
+    {
+        // the checkpoint takes every seat in turn while the reference plays the others
+        for (int seat = 0; seat < GAME::playerNum(); ++seat)
+        {
+            for (int p = 0; p < GAME::playerNum(); ++p)
+            {
+                strategies[p] = strategyFunction(p == seat ? *checkpoint.strategy : *reference, uniform);
+            }
+            checkpoint.crossEV += Trainer::Trainer<GAME>::CalculatePayoff(root, strategies)[seat] / double(GAME::playerNum());
+        }
+    }
+    checkpoint.evalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// main function
+int main(int argc, char *argv[])
+{
+    // parse arguments
+    cmdline::parser p;
+    p.add<std::string>("dir", 'd', "Directory holding the strategy files", false, "../strategies/" + GAME::name());
+    p.add<std::string>("mode", 'm', "Only evaluate the files of this CFR variant (default: every variant)", false, "");
+    p.add<std::string>("reference", 'r', "Strategy file the cross-EV is measured against (default: the final strategy of each variant)", false, "");
+    p.add<int>("threads", 'j', "Number of worker threads (default: one per hardware thread)", false, 0);
+    p.add<std::string>("output", 'o', "Path of the convergence CSV (default: standard output)", false, "");
+    p.parse_check(argc, argv);
+
+    // collect the strategy files, ordered by variant and iteration with the final strategy last
+    std::vector<Checkpoint> checkpoints;
+    const boost::filesystem::path dir(p.get<std::string>("dir"));
+    if (!boost::filesystem::is_directory(dir))
+    {
+        std::cerr << "\"" << dir.string() << "\" is not a directory" << std::endl;
+        return 1;
+    }
+    for (boost::filesystem::directory_iterator itr(dir), end; itr != end; ++itr)
+    {
+        Checkpoint checkpoint = Checkpoint();
+        if (boost::filesystem::is_regular_file(itr->status()) && parseName(itr->path().filename().string(), checkpoint) &&
+            (p.get<std::string>("mode").empty() || checkpoint.mode == p.get<std::string>("mode")))
+        {
+            checkpoint.path = itr->path().string();
+            checkpoints.push_back(checkpoint);
+        }
+    }
+    std::sort(checkpoints.begin(), checkpoints.end(), [](const Checkpoint &lhs, const Checkpoint &rhs)
+              { return std::make_tuple(lhs.mode, lhs.isFinal, lhs.iteration) < std::make_tuple(rhs.mode, rhs.isFinal, rhs.iteration); });
+    if (checkpoints.empty())
+    {
+        std::cerr << "no strategy files in \"" << dir.string() << "\"" << std::endl;
+        return 1;
+    }
+
+    int threadNum = p.get<int>("threads");
+    if (threadNum <= 0)
+    {
+        threadNum = std::max(1, int(std::thread::hardware_concurrency()));
+    }
+    threadNum = std::min(threadNum, int(checkpoints.size()));
+
+    // every file is deserialized exactly once, in parallel
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> workers;
+    const auto runWorkers = [&](const std::function<void(Checkpoint &)> &task)
+    {
+        next = 0;
+        for (int t = 0; t < threadNum; ++t)
+        {
+            workers.emplace_back([&]()
+                                 {
+                                     for (size_t i = next++; i < checkpoints.size(); i = next++)
+                                     {
+                                         task(checkpoints[i]);
+                                     } });
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        workers.clear();
+    };
+    runWorkers([](Checkpoint &checkpoint)
+               {
+                   const auto start = std::chrono::steady_clock::now();
+                   try
+                   {
+                       checkpoint.strategy = loadStrategy(checkpoint.path);
+                   }
+                   catch (const std::exception &e)
+                   {
+                       // a run that is still training may have a file half written
+                       checkpoint.loadError = e.what();
+                   }
+                   checkpoint.loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(); });
+
+    // pick the reference of every variant: the given file, else the final strategy, else the latest checkpoint
+    StrategyMap *givenReference = nullptr;
+    bool loaded = true;
+    if (!p.get<std::string>("reference").empty())
+    {
+        try
+        {
+            givenReference = loadStrategy(p.get<std::string>("reference"));
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "cannot load \"" << p.get<std::string>("reference") << "\": " << e.what() << std::endl;
+            loaded = false;
+        }
+    }
+    for (const Checkpoint &checkpoint : checkpoints)
+    {
+        if (checkpoint.strategy == nullptr)
+        {
+            std::cerr << "cannot load \"" << checkpoint.path << "\": " << checkpoint.loadError << std::endl;
+            loaded = false;
+        }
+    }
+    if (!loaded)
+    {
+        for (Checkpoint &checkpoint : checkpoints)
+        {
+            if (checkpoint.strategy != nullptr)
+            {
+                deleteStrategy(checkpoint.strategy);
+            }
+        }
+        if (givenReference != nullptr)
+        {
+            deleteStrategy(givenReference);
+        }
+        return 1;
+    }
+    std::map<std::string, const StrategyMap *> references;
+    for (const Checkpoint &checkpoint : checkpoints)
+    {
+        references[checkpoint.mode] = givenReference != nullptr ? givenReference : checkpoint.strategy;
+    }
+
+    std::mt19937 engine(0);
+    GAME root(engine);
+    root.resetGame(false);
+    // nodes store their action count as uint8_t, which bounds the action count of every information set
+    std::vector<std::vector<double>> uniform(std::numeric_limits<uint8_t>::max() + 1);
+    for (int a = 1; a < int(uniform.size()); ++a)
+    {
+        uniform[a].assign(a, 1.0 / double(a));
+    }
+    runWorkers([&](Checkpoint &checkpoint)
+               { evaluate(checkpoint, references[checkpoint.mode], root, uniform); });
+
+    // report
+    std::ofstream outputFile;
+    if (!p.get<std::string>("output").empty())
+    {
+        outputFile.open(p.get<std::string>("output"));
+    }
+    std::ostream &output = outputFile.is_open() ? outputFile : std::cout;
+    output << "file,mode,iteration,infosets,exploitability,self_ev,cross_ev,load_seconds,eval_seconds\n";
+    for (const Checkpoint &checkpoint : checkpoints)
+    {
+        output << boost::filesystem::path(checkpoint.path).filename().string() << "," << checkpoint.mode << ",";
+        if (checkpoint.isFinal)
+        {
+            output << "final";
+        }
+        else
+        {
+            output << checkpoint.iteration;
+        }
+        output << "," << checkpoint.strategy->size() << "," << checkpoint.exploitability << "," << checkpoint.selfEV << ","
+               << checkpoint.crossEV << "," << checkpoint.loadSeconds << "," << checkpoint.evalSeconds << "\n";
+    }
+    output.flush();
+
+    // finalize
+    for (Checkpoint &checkpoint : checkpoints)
+    {
+        deleteStrategy(checkpoint.strategy);
+    }
+    if (givenReference != nullptr)
+    {
+        deleteStrategy(givenReference);
+    }
+}
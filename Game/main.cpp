@@ -1,18 +1,190 @@
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <iomanip>
 #include <iostream>
 #include <random>
 #include <string>
+#include <thread>
 #include <vector>
 #include "cmdline.h"
 #include "CFRAgent.hpp"
 #include "CFRAgent.cpp"
 #include "Game.hpp"
+#include "LocalBestResponse.hpp"
+#include "LocalBestResponse.cpp"
 #include "Trainer.hpp"
 #include "Trainer.cpp"
 
 // defines the game
 #define GAME Kuhn::Game
 
+// @brief Plays every strategy against every other one exactly and evaluates the exploitability of each.
+// @param paths The paths of the strategy files.
+// @param threadNum The number of threads.
+// @param engine The random generator handed to the agents.
+// @return The exit code: 0 on success, 1 if a file cannot be loaded.
+// @details Every file is loaded once. The payoff of agent i against agent j is averaged over every seat i can take
+//          while j takes all other seats, and each seating is one exact traversal. Each thread expands the game tree
+//          once into an incremental exploitability evaluator and feeds it a contiguous run of strategies, so that
+//          consecutive checkpoints only refresh the information sets that changed between them.
+static int RunTournament(const std::vector<std::string> &paths, const int threadNum, std::mt19937 &engine)
+{
+    const int agentNum = int(paths.size());
+    const int playerNum = GAME::playerNum();
+
+    // load the strategies in parallel; deserialization dominates for many files
+    std::vector<Agent::CFRAgent<GAME> *> agents(agentNum, nullptr);
+    std::vector<std::function<const double *(const GAME &)>> strategies(agentNum);
+    std::vector<std::string> loadErrors(agentNum);
+    std::atomic<int> nextLoad(0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threadNum; ++t)
+    {
+        workers.emplace_back([&]()
+                             {
+                                 for (int i = nextLoad++; i < agentNum; i = nextLoad++)
+                                 {
+                                     try
+                                     {
+                                         agents[i] = new Agent::CFRAgent<GAME>(engine, paths[i]);
+                                     }
+                                     catch (const std::exception &e)
+                                     {
+                                         loadErrors[i] = e.what();
+                                         continue;
+                                     }
+                                     const Agent::CFRAgent<GAME> &agent = *agents[i];
+                                     strategies[i] = [&agent](const GAME &game)
+                                     { return agent.strategy(game); };
+                                 } });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+    bool loaded = true;
+    for (int i = 0; i < agentNum; ++i)
+    {
+        if (agents[i] == nullptr)
+        {
+            std::cerr << "cannot load \"" << paths[i] << "\": " << loadErrors[i] << std::endl;
+            loaded = false;
+        }
+    }
+    if (!loaded)
+    {
+        for (Agent::CFRAgent<GAME> *agent : agents)
+        {
+            delete agent;
+        }
+        return 1;
+    }
+
+    // with two players the traversal that seats i first also gives j's payoff in the second seat
+    const int seatJobs = playerNum == 2 ? 1 : playerNum;
+    const int64_t jobNum = int64_t(agentNum) * agentNum * seatJobs;
+    std::vector<double> seatPayoffs(size_t(playerNum) * agentNum * agentNum, 0.0); // payoff of i in seat s against j at [(s * K + i) * K + j]
+    std::vector<double> exploitabilities(agentNum, 0.0);
+    std::atomic<int64_t> nextJob(0);
+    GAME root(engine);
+    root.resetGame(false);
+    for (int t = 0; t < threadNum; ++t)
+    {
+        workers.emplace_back([&, t]()
+                             {
+                                 // exploitability of the self-play profile of a contiguous run of strategies
+                                 const int first = int(int64_t(agentNum) * t / threadNum), last = int(int64_t(agentNum) * (t + 1) / threadNum);
+                                 if (first < last)
+                                 {
+                                     Trainer::IncrementalExploitability<GAME> evaluator(root);
+                                     for (int i = first; i < last; ++i)
+                                     {
+                                         exploitabilities[i] = evaluator.evaluate(std::vector<std::function<const double *(const GAME &)>>(playerNum, strategies[i]));
+                                     }
+                                 }
+
+                                 // exact payoffs of every seating
+                                 std::vector<std::function<const double *(const GAME &)>> seating(playerNum);
+                                 for (int64_t job = nextJob++; job < jobNum; job = nextJob++)
+                                 {
+                                     const int seat = int(job % seatJobs);
+                                     const int j = int(job / seatJobs % agentNum), i = int(job / seatJobs / agentNum);
+                                     for (int s = 0; s < playerNum; ++s)
+                                     {
+                                         seating[s] = strategies[s == seat ? i : j];
+                                     }
+                                     const std::vector<double> payoffs = Trainer::Trainer<GAME>::CalculatePayoff(root, seating);
+                                     seatPayoffs[(size_t(seat) * agentNum + i) * agentNum + j] = payoffs[seat];
+                                     if (playerNum == 2)
+                                     {
+                                         seatPayoffs[(size_t(1) * agentNum + j) * agentNum + i] = payoffs[1];
+                                     }
+                                 } });
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    // report the payoff matrix of every seat and their average, then each strategy's mean payoff against the field and
+    // its exploitability
+    std::vector<double> averagePayoffs(size_t(agentNum) * agentNum, 0.0);
+    for (int s = 0; s < playerNum; ++s)
+    {
+        for (size_t k = 0; k < averagePayoffs.size(); ++k)
+        {
+            averagePayoffs[k] += seatPayoffs[size_t(s) * agentNum * agentNum + k] / double(playerNum);
+        }
+    }
+    for (int s = 0; s <= playerNum; ++s)
+    {
+        const double *payoffs = s < playerNum ? seatPayoffs.data() + size_t(s) * agentNum * agentNum : averagePayoffs.data();
+        if (s < playerNum)
+        {
+            std::cout << "expected payoff of the row strategy in seat " << s << " against the column strategy in every other seat:" << std::endl;
+        }
+        else
+        {
+            std::cout << "expected payoff of the row strategy against the column strategy, averaged over seats:" << std::endl;
+        }
+        std::cout << std::setw(6) << "";
+        for (int j = 0; j < agentNum; ++j)
+        {
+            std::cout << std::setw(11) << j;
+        }
+        std::cout << std::endl;
+        for (int i = 0; i < agentNum; ++i)
+        {
+            std::cout << std::setw(6) << i;
+            for (int j = 0; j < agentNum; ++j)
+            {
+                std::cout << std::setw(11) << std::fixed << std::setprecision(6) << payoffs[size_t(i) * agentNum + j];
+            }
+            std::cout << std::endl;
+        }
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << std::setprecision(6);
+    for (int i = 0; i < agentNum; ++i)
+    {
+        double fieldPayoff = 0.0;
+        for (int j = 0; j < agentNum; ++j)
+        {
+            fieldPayoff += averagePayoffs[size_t(i) * agentNum + j] / double(agentNum);
+        }
+        std::cout << i << ": " << paths[i] << ", payoff against the field " << fieldPayoff << ", exploitability " << exploitabilities[i] << std::endl;
+    }
+
+    // finalize
+    for (Agent::CFRAgent<GAME> *agent : agents)
+    {
+        delete agent;
+    }
+    return 0;
+}
+
 // main function
 int main(int argc, char *argv[])
 {
@@ -22,14 +194,42 @@ int main(int argc, char *argv[])
     for (int i = 0; i < GAME::playerNum(); ++i)
     {
         p.add<std::string>("strategy-path-" + std::to_string(i), 0,
-                           "Path to the binary file that represents the average strategy for player " + std::to_string(i), true); // Add arguments for each player's strategy file path
+                           "Path to the binary file that represents the average strategy for player " + std::to_string(i), false); // Add arguments for each player's strategy file path
     }
+    p.add<uint64_t>("lbr-hands", 0, "Number of hands played by the local best response estimator (0 disables it)", false, 0); // Add an optional argument for the sampled exploitability estimate
+    p.add<int>("lbr-samples", 0, "Number of deals sampled for the local best response belief at each decision", false, 32);  // Add an optional argument for the belief size
+    p.add<int>("lbr-rollouts", 0, "Number of rollouts per belief sample and action of the local best response", false, 1);   // Add an optional argument for the rollout count
+    p.add<int>("lbr-threads", 0, "Number of threads of the local best response (default: one per hardware thread)", false, 0); // Add an optional argument for the thread count
+    p.add("tournament", 't', "Evaluate every strategy file given after the options against every other one, exactly and in parallel"); // Add an optional flag for the tournament mode
+    p.add<int>("threads", 'j', "Number of threads of the tournament (default: one per hardware thread)", false, 0);                 // Add an optional argument for the tournament's thread count
+    p.footer("[strategy files of the tournament ...]"); // Describe the positional arguments of the tournament
     p.parse_check(argc, argv); // Parse and check the command-line arguments
 
     // create game
     std::mt19937 engine(p.exist("seed") ? p.get<uint32_t>("seed") : std::random_device()()); // Initialize the random generator with the provided seed or a random seed
     GAME game(engine);                                                                       // Create an instance of the game
 
+    // compare many strategies at once, sharing the loaded files and the traversal structures
+    if (p.exist("tournament"))
+    {
+        if (p.rest().empty())
+        {
+            std::cerr << "the tournament needs at least one strategy file" << std::endl
+                      << p.usage();
+            return 1;
+        }
+        return RunTournament(p.rest(), p.get<int>("threads") > 0 ? p.get<int>("threads") : std::max(1, int(std::thread::hardware_concurrency())), engine);
+    }
+    for (int i = 0; i < GAME::playerNum(); ++i)
+    {
+        if (!p.exist("strategy-path-" + std::to_string(i)))
+        {
+            std::cerr << "need option: --strategy-path-" << i << std::endl
+                      << p.usage();
+            return 1;
+        }
+    }
+
     // initialize strategies
     std::vector<Agent::CFRAgent<GAME> *> cfrAgents(GAME::playerNum());                      // Vector to hold CFR agents for each player
     std::vector<std::function<const double *(const GAME &)>> strategies(GAME::playerNum()); // Vector to hold strategy functions for each player
@@ -56,6 +256,24 @@ int main(int argc, char *argv[])
     double exploitability = Trainer::Trainer<GAME>::CalculateExploitability(game, strategies); // Calculate the exploitability of the given strategies
     std::cout << "strategy exploitability: " << exploitability << std::endl;                   // Output the exploitability
 
+    // estimate exploitability by sampling, which scales to games whose tree cannot be traversed
+    if (p.get<uint64_t>("lbr-hands") > 0)
+    {
+        Trainer::LocalBestResponseConfig config;
+        config.hands = p.get<uint64_t>("lbr-hands");
+        config.beliefSamples = p.get<int>("lbr-samples");
+        config.rollouts = p.get<int>("lbr-rollouts");
+        config.threadNum = p.get<int>("lbr-threads") > 0 ? p.get<int>("lbr-threads") : std::max(1, int(std::thread::hardware_concurrency()));
+        config.seed = engine(); // Derive the seeds of the estimator's threads from the main generator
+        const Trainer::LocalBestResponseResult lbr = Trainer::LocalBestResponse<GAME>(config).evaluate(strategies);
+        std::cout << "local best response exploitability: " << lbr.exploitability << " +- " << lbr.halfWidth << " (95%, " << lbr.hands << " hands, per seat: ";
+        for (int i = 0; i < GAME::playerNum(); ++i)
+        {
+            std::cout << lbr.value[i] << ","; // Print the mean payoff of the responder in each seat
+        }
+        std::cout << ")" << std::endl;
+    }
+
     // finalize
     for (int i = 0; i < GAME::playerNum(); ++i)
     {
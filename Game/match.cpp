@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cmdline.h"
+#include "CFRAgent.hpp"
+#include "CFRAgent.cpp"
+#include "Game.hpp"
+#include "MatchSimulator.hpp"
+#include "MatchSimulator.cpp"
+
+// defines the game
+#define GAME Kuhn::Game
+
+// main function
+int main(int argc, char *argv[])
+{
+    // parse arguments
+    cmdline::parser p;
+    for (int i = 0; i < GAME::playerNum(); ++i)
+    {
+        p.add<std::string>("strategy-path-" + std::to_string(i), 0, "Path to the binary strategy file of agent " + std::to_string(i), true);
+    }
+    p.add<uint64_t>("hands", 'n', "Number of hands to play", false, 1000000);
+    p.add<int>("threads", 'j', "Number of threads (default: one per hardware thread)", false, 0);
+    p.add<uint32_t>("seed", 's', "Random seed used to initialize the random generators", false);
+    p.add("duplicate", 'd', "Replay every deal once per seat rotation with the same cards, and report the paired outcomes");
+    p.add("aivat", 'a', "Also report payoffs corrected by control variates from the agents' own strategy values (small games only)");
+    p.parse_check(argc, argv);
+
+    // load the agents; an agent given twice is loaded once
+    std::mt19937 engine(p.exist("seed") ? p.get<uint32_t>("seed") : std::random_device()());
+    std::vector<std::string> paths;
+    std::vector<Agent::CFRAgent<GAME> *> loaded;
+    std::vector<const Agent::CFRAgent<GAME> *> agents;
+    for (int i = 0; i < GAME::playerNum(); ++i)
+    {
+        const std::string path = p.get<std::string>("strategy-path-" + std::to_string(i));
+        const size_t index = size_t(std::find(paths.begin(), paths.end(), path) - paths.begin());
+        if (index == paths.size())
+        {
+            paths.push_back(path);
+            loaded.push_back(new Agent::CFRAgent<GAME>(engine, path));
+        }
+        agents.push_back(loaded[index]);
+    }
+
+    // play the match
+    const int threadNum = p.get<int>("threads") > 0 ? p.get<int>("threads") : std::max(1, int(std::thread::hardware_concurrency()));
+    Agent::MatchSimulator<GAME> simulator(agents, threadNum, engine());
+    simulator.setDuplicate(p.exist("duplicate"));
+    simulator.setControlVariates(p.exist("aivat"));
+    const Agent::MatchResult result = simulator.play(p.get<uint64_t>("hands"));
+
+    // report the means with 95% confidence intervals
+    std::cout << result.hands << " hands in " << result.seconds << " s (" << (result.seconds > 0.0 ? double(result.hands) / result.seconds : 0.0)
+              << " hands/s, " << threadNum << " threads)" << std::endl;
+    if (p.exist("duplicate"))
+    {
+        std::cout << result.deals << " duplicate deals, each played in " << GAME::playerNum() << " seatings" << std::endl;
+    }
+    for (int i = 0; i < GAME::playerNum(); ++i)
+    {
+        std::cout << "agent " << i << ": payoff " << result.payoff[i] << " +- " << 1.96 * result.stdErr[i] << ", win rate "
+                  << result.winRate[i] << " +- " << 1.96 * result.winErr[i];
+        if (p.exist("duplicate") && result.stdErr[i] > 0.0)
+        {
+            // the ratio of variances is the factor by which duplicate deals cut the hands needed for the same interval
+            const double ratio = result.unpairedStdErr[i] / result.stdErr[i];
+            std::cout << " (unpaired +- " << 1.96 * result.unpairedStdErr[i] << ", " << ratio * ratio << "x fewer hands)";
+        }
+        std::cout << std::endl;
+        if (p.exist("aivat"))
+        {
+            std::cout << "agent " << i << ": corrected payoff " << result.correctedPayoff[i] << " +- " << 1.96 * result.correctedStdErr[i];
+            if (result.correctedStdErr[i] > 0.0)
+            {
+                const double ratio = result.stdErr[i] / result.correctedStdErr[i];
+                std::cout << " (" << ratio * ratio << "x fewer hands)";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    // finalize
+    for (Agent::CFRAgent<GAME> *agent : loaded)
+    {
+        delete agent;
+    }
+}
@@ -0,0 +1,461 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "cmdline.h"
+#include "CFRAgent.hpp"
+#include "CFRAgent.cpp"
+#include "Game.hpp"
+#include "Socket.hpp"
+
+// defines the game
+#define GAME Kuhn::Game
+
+// Largest request line accepted; longer lines close the connection.
+static const size_t maxLineBytes = 4096;
+
+// Unsent response bytes above which a connection is no longer read until its client catches up.
+static const size_t maxOutputBytes = 1 << 20;
+
+// Flags set by the signal handler.
+static volatile std::sig_atomic_t stopRequested = 0;
+static volatile std::sig_atomic_t reloadRequested = 0;
+
+// @brief Records SIGINT and SIGTERM as a stop request and SIGHUP as a reload request.
+// @param signum The received signal.
+static void onSignal(const int signum)
+{
+    if (signum == SIGHUP)
+    {
+        reloadRequested = 1;
+    }
+    else
+    {
+        stopRequested = 1;
+    }
+}
+
+// @brief A client connection.
+struct Connection
+{
+    uint64_t id;        // Number of the connection, never reused by the process.
+    std::string input;  // Received bytes not yet forming a complete line.
+    std::string output; // Responses not yet accepted by the socket.
+};
+
+// @brief A request line waiting for the next batch.
+struct Query
+{
+    int fd;               // Socket of the connection the response is written to.
+    uint64_t connection;  // Number of that connection, so that a later connection reusing the socket is not answered.
+    char op;              // 'S' to sample an action, 'P' for the probabilities, 0 if the response is already known.
+    std::string key;      // Decoded information set key of 'S' and 'P' queries.
+    std::string response; // Response line, filled when the batch is answered.
+};
+
+// @brief Sends as much pending output as the socket accepts without blocking.
+// @param fd The non-blocking socket.
+// @param output The pending output; the bytes sent are removed from it.
+// @return False if the connection failed and should be closed.
+static bool flush(const int fd, std::string &output)
+{
+    size_t written = 0;
+    while (written < output.size())
+    {
+        const ssize_t n = ::send(fd, output.data() + written, output.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        if (n <= 0)
+        {
+            return false;
+        }
+        written += size_t(n);
+    }
+    output.erase(0, written);
+    return true;
+}
+
+// @brief Decodes a hexadecimal string.
+// @param hex The hexadecimal digits, two per byte.
+// @param bytes Receives the decoded bytes.
+// @return True if the string is valid hexadecimal.
+static bool decodeHex(const std::string &hex, std::string &bytes)
+{
+    if (hex.size() % 2 != 0)
+    {
+        return false;
+    }
+    bytes.resize(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); ++i)
+    {
+        const char c = hex[i];
+        int digit;
+        if (c >= '0' && c <= '9')
+        {
+            digit = c - '0';
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            digit = c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            digit = c - 'A' + 10;
+        }
+        else
+        {
+            return false;
+        }
+        bytes[i / 2] = char(i % 2 == 0 ? digit << 4 : (bytes[i / 2] & 0xf0) | digit);
+    }
+    return true;
+}
+
+// @brief Formats the response of an answered 'S' or 'P' query.
+// @param op The query operation.
+// @param row The strategy probabilities.
+// @param actionNum The number of actions.
+// @param action The sampled action.
+// @return The response line.
+static std::string formatAnswer(const char op, const double *row, const int actionNum, const int action)
+{
+    if (op == 'S')
+    {
+        return std::to_string(action) + "\n";
+    }
+    std::string line;
+    char number[32];
+    for (int a = 0; a < actionNum; ++a)
+    {
+        std::snprintf(number, sizeof(number), a == 0 ? "%.17g" : " %.17g", row[a]);
+        line += number;
+    }
+    return line + "\n";
+}
+
+// @brief Answers the 'S' and 'P' queries of a batch with one agent call per operation.
+// @param agent The agent.
+// @param queries The queries of the batch.
+// @param engine The random generator of the sampled actions.
+static void answer(const Agent::CFRAgent<GAME> &agent, std::vector<Query> &queries, std::mt19937 &engine)
+{
+    std::vector<size_t> indices;
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < queries.size(); ++i)
+    {
+        if (queries[i].op != 0)
+        {
+            indices.push_back(i);
+            keys.push_back(queries[i].key);
+        }
+    }
+    if (keys.empty())
+    {
+        return;
+    }
+
+    // the probabilities are looked up for every query; sampling draws only for the 'S' queries
+    std::vector<const double *> rows(keys.size());
+    std::vector<int> actionNums(keys.size()), actions(keys.size(), 0);
+    try
+    {
+        agent.strategies(keys.data(), keys.size(), rows.data(), actionNums.data());
+        std::vector<std::string> sampleKeys;
+        std::vector<size_t> sampleIndices;
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            if (queries[indices[i]].op == 'S')
+            {
+                sampleKeys.push_back(keys[i]);
+                sampleIndices.push_back(i);
+            }
+        }
+        std::vector<int> sampled(sampleKeys.size());
+        agent.chooseActions(sampleKeys.data(), sampleKeys.size(), sampled.data(), engine);
+        for (size_t i = 0; i < sampleIndices.size(); ++i)
+        {
+            actions[sampleIndices[i]] = sampled[i];
+        }
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            queries[indices[i]].response = formatAnswer(queries[indices[i]].op, rows[i], actionNums[i], actions[i]);
+        }
+    }
+    catch (const std::out_of_range &)
+    {
+        // an unknown key fails the whole batch; answer its queries one by one to single it out
+        for (size_t i = 0; i < indices.size(); ++i)
+        {
+            Query &query = queries[indices[i]];
+            try
+            {
+                agent.strategies(&query.key, 1, &rows[i], &actionNums[i]);
+                if (query.op == 'S')
+                {
+                    agent.chooseActions(&query.key, 1, &actions[i], engine);
+                }
+                query.response = formatAnswer(query.op, rows[i], actionNums[i], actions[i]);
+            }
+            catch (const std::out_of_range &)
+            {
+                query.response = "E unknown infoset\n";
+            }
+        }
+    }
+}
+
+// main function
+int main(int argc, char *argv[])
+{
+    // parse arguments
+    cmdline::parser p;
+    p.add<std::string>("strategy-path", 'f', "Path to the binary strategy file served", true);
+    p.add<std::string>("listen", 'l', "Unix socket path, or loopback TCP port, to listen on", false, "/tmp/grasp_" + GAME::name() + ".sock");
+    p.add<int>("max-batch", 'b', "Largest number of queries answered by one agent call", false, 4096);
+    p.add<int>("batch-wait", 'w', "Microseconds spent collecting more queries before answering a partial batch", false, 0);
+    p.add<uint32_t>("seed", 's', "Random seed used to initialize the random generator", false);
+    p.parse_check(argc, argv);
+
+    const std::string strategyPath = p.get<std::string>("strategy-path");
+    const size_t maxBatch = size_t(std::max(1, p.get<int>("max-batch")));
+    const int batchWait = std::max(0, p.get<int>("batch-wait"));
+    std::mt19937 engine(p.exist("seed") ? p.get<uint32_t>("seed") : std::random_device()());
+
+    // load the strategy and listen
+    Agent::CFRAgent<GAME> *agentPtr;
+    try
+    {
+        agentPtr = new Agent::CFRAgent<GAME>(engine, strategyPath);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "cannot load \"" << strategyPath << "\": " << e.what() << std::endl;
+        return 1;
+    }
+    Agent::CFRAgent<GAME> &agent = *agentPtr;
+    std::string socketPath;
+    int listenFd;
+    try
+    {
+        listenFd = Metrics::listenOn(p.get<std::string>("listen"), 128, socketPath);
+    }
+    catch (const std::runtime_error &e)
+    {
+        std::cerr << e.what() << std::endl;
+        delete agentPtr;
+        return 1;
+    }
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::signal(SIGHUP, onSignal);
+    std::cerr << "serving \"" << strategyPath << "\" on " << p.get<std::string>("listen") << std::endl;
+
+    std::unordered_map<int, Connection> connections;
+    uint64_t nextConnectionId = 0;
+    std::vector<Query> queries;
+    std::future<void> pendingReload;
+    std::string pendingReloadPath;
+    std::vector<pollfd> pfds;
+    while (!stopRequested)
+    {
+        if (reloadRequested)
+        {
+            reloadRequested = 0;
+            if (!pendingReload.valid())
+            {
+                pendingReloadPath = strategyPath;
+                pendingReload = agent.reloadAsync(strategyPath);
+            }
+        }
+
+        // collect the requests of every ready connection; with a batch wait, keep collecting until the batch is full
+        // or the wait is over
+        const auto collectStart = std::chrono::steady_clock::now();
+        int timeout = pendingReload.valid() ? 10 : 200;
+        while (true)
+        {
+            pfds.clear();
+            pfds.push_back(pollfd{listenFd, POLLIN, 0});
+            for (const auto &itr : connections)
+            {
+                // a client that does not read its responses is not read either, so that its backlog stays bounded
+                const short events = short((itr.second.output.size() < maxOutputBytes ? POLLIN : 0) | (itr.second.output.empty() ? 0 : POLLOUT));
+                pfds.push_back(pollfd{itr.first, events, 0});
+            }
+            if (::poll(pfds.data(), pfds.size(), timeout) <= 0)
+            {
+                break;
+            }
+            if (pfds[0].revents & POLLIN)
+            {
+                const int fd = ::accept(listenFd, nullptr, nullptr);
+                if (fd >= 0)
+                {
+                    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+                    connections[fd] = Connection{nextConnectionId++, std::string(), std::string()};
+                }
+            }
+            for (size_t i = 1; i < pfds.size(); ++i)
+            {
+                if (pfds[i].revents == 0)
+                {
+                    continue;
+                }
+                const int fd = pfds[i].fd;
+                Connection &connection = connections[fd];
+                if ((pfds[i].revents & POLLOUT) && !flush(fd, connection.output))
+                {
+                    ::close(fd);
+                    connections.erase(fd);
+                    continue;
+                }
+                if ((pfds[i].revents & (POLLIN | POLLHUP | POLLERR)) == 0)
+                {
+                    continue;
+                }
+                char buffer[65536];
+                const ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+                if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+                {
+                    continue;
+                }
+                if (n <= 0)
+                {
+                    ::close(fd);
+                    connections.erase(fd);
+                    continue;
+                }
+                connection.input.append(buffer, size_t(n));
+
+                // every complete line becomes a query, so that responses keep the order of the requests
+                size_t begin = 0;
+                for (size_t end = connection.input.find('\n'); end != std::string::npos; end = connection.input.find('\n', begin))
+                {
+                    std::string line = connection.input.substr(begin, end - begin);
+                    begin = end + 1;
+                    if (!line.empty() && line.back() == '\r')
+                    {
+                        line.pop_back();
+                    }
+                    Query query{fd, connection.id, 0, std::string(), std::string()};
+                    if (line.size() > 2 && (line[0] == 'S' || line[0] == 'P') && line[1] == ' ')
+                    {
+                        query.op = line[0];
+                        if (!decodeHex(line.substr(2), query.key))
+                        {
+                            query.op = 0;
+                            query.response = "E key is not hexadecimal\n";
+                        }
+                    }
+                    else if (line == "G")
+                    {
+                        query.response = std::to_string(agent.generation()) + "\n";
+                    }
+                    else if (line == "R" || line.compare(0, 2, "R ") == 0)
+                    {
+                        if (pendingReload.valid())
+                        {
+                            query.response = "E reload in progress\n";
+                        }
+                        else
+                        {
+                            pendingReloadPath = line.size() > 2 ? line.substr(2) : strategyPath;
+                            pendingReload = agent.reloadAsync(pendingReloadPath);
+                            query.response = "OK reloading\n";
+                        }
+                    }
+                    else
+                    {
+                        query.response = "E bad request\n";
+                    }
+                    queries.push_back(query);
+                }
+                connection.input.erase(0, begin);
+                if (connection.input.size() > maxLineBytes)
+                {
+                    ::close(fd);
+                    connections.erase(fd);
+                }
+            }
+
+            const int waited = int(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - collectStart).count());
+            if (queries.empty() || queries.size() >= maxBatch || waited >= batchWait)
+            {
+                break;
+            }
+            timeout = std::max(1, (batchWait - waited) / 1000);
+        }
+
+        // answer the batch, then send each connection as much of its responses as the socket accepts
+        for (size_t begin = 0; begin < queries.size(); begin += maxBatch)
+        {
+            std::vector<Query> batch(queries.begin() + begin, queries.begin() + std::min(queries.size(), begin + maxBatch));
+            answer(agent, batch, engine);
+            for (const Query &query : batch)
+            {
+                auto itr = connections.find(query.fd);
+                if (itr != connections.end() && itr->second.id == query.connection)
+                {
+                    itr->second.output += query.response;
+                }
+            }
+        }
+        queries.clear();
+        for (auto itr = connections.begin(); itr != connections.end();)
+        {
+            if (!flush(itr->first, itr->second.output))
+            {
+                ::close(itr->first);
+                itr = connections.erase(itr);
+                continue;
+            }
+            ++itr;
+        }
+
+        // report finished reloads
+        if (pendingReload.valid() && pendingReload.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        {
+            try
+            {
+                pendingReload.get();
+                std::cerr << "serving \"" << pendingReloadPath << "\" (generation " << agent.generation() << ")" << std::endl;
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << "cannot reload \"" << pendingReloadPath << "\": " << e.what() << std::endl;
+            }
+        }
+    }
+
+    // finalize
+    if (pendingReload.valid())
+    {
+        pendingReload.wait();
+    }
+    for (const auto &itr : connections)
+    {
+        ::close(itr.first);
+    }
+    ::close(listenFd);
+    Metrics::removeSocket(socketPath);
+    delete agentPtr;
+}